@@ -19,6 +19,7 @@
 // libevocosm
 #include "organism.h"
 #include "listener.h"
+#include "checkpoint.h"
 
 namespace libevocosm
 {
@@ -92,6 +93,28 @@ namespace libevocosm
                 return true;
         }
 
+        //! Write state to a checkpoint
+        /*!
+            An analyzer that remembers things from one generation to the next
+            must save them here, for evocosm::save_checkpoint. The default
+            analyzer has no such state, and writes nothing.
+            \param a_out - Checkpoint being written
+        */
+        virtual void save_state(checkpoint_writer & a_out) const
+        {
+            // nada
+        }
+
+        //! Read state from a checkpoint
+        /*!
+            Reads back exactly what save_state wrote.
+            \param a_in - Checkpoint being read
+        */
+        virtual void restore_state(checkpoint_reader & a_in)
+        {
+            // nada
+        }
+
     protected:
         //! The listener for events
         listener<OrganismType> & m_listener;
@@ -0,0 +1,681 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_ARCHIPELAGO_H)
+#define LIBEVOCOSM_ARCHIPELAGO_H
+
+// Standard C++ Library
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// libevocosm
+#include "evocosm.h"
+#include "genome_pool.h"
+#include "mpmc_queue.h"
+#include "numa_topology.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! State shared by the islands of an archipelago
+    /*!
+        When islands are processes, this lives in shared memory; its
+        members are lock-free atomics, which work across processes.
+    */
+    struct migration_status
+    {
+        //! Tells islands to stop
+        std::atomic<bool> stop;
+
+        //! Migrants delivered
+        std::atomic<unsigned long long int> sent;
+
+        //! Migrants dropped because a mailbox was full
+        std::atomic<unsigned long long int> dropped;
+    };
+
+    //! Carries migrants between islands
+    /*!
+        Each island has a mailbox; any island may post to it, and only its
+        owner collects from it. Neither operation may block.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class migration_channel
+    {
+    public:
+        //! Virtual destructor
+        virtual ~migration_channel()
+        {
+            // nada
+        }
+
+        //! Send a migrant
+        /*!
+            \param a_island - Destination island
+            \param a_migrant - The migrant, which is copied
+            \return <b>false</b> if the migrant was dropped
+        */
+        virtual bool post(size_t a_island, const OrganismType & a_migrant) = 0;
+
+        //! Receive a migrant
+        /*!
+            \param a_island - The receiving island
+            \param a_arrivals - The migrant is appended to this vector
+            \return <b>false</b> if no migrant was waiting
+        */
+        virtual bool collect(size_t a_island, vector<OrganismType> & a_arrivals) = 0;
+
+        //! Get the status shared by all islands
+        virtual migration_status & status() = 0;
+    };
+
+    //! Carries migrants between threads
+    /*!
+        Each mailbox is an mpmc_queue of copies of organisms, allocated on
+        the heap, so organisms need not be default-constructible.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class queue_channel : public migration_channel<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_capacities - Minimum capacity of each island's mailbox
+        */
+        queue_channel(const vector<size_t> & a_capacities)
+          : m_mailboxes(),
+            m_status()
+        {
+            for (size_t n = 0; n < a_capacities.size(); ++n)
+                m_mailboxes.push_back(std::unique_ptr< mpmc_queue<OrganismType *> >(new mpmc_queue<OrganismType *>(a_capacities[n])));
+
+            m_status.stop.store(false);
+            m_status.sent.store(0);
+            m_status.dropped.store(0);
+        }
+
+        //! Destructor
+        /*!
+            Deletes migrants that were never collected.
+        */
+        virtual ~queue_channel()
+        {
+            OrganismType * migrant = NULL;
+
+            for (size_t n = 0; n < m_mailboxes.size(); ++n)
+            {
+                while (m_mailboxes[n]->try_pop(migrant))
+                    delete migrant;
+            }
+        }
+
+        //! Send a migrant
+        virtual bool post(size_t a_island, const OrganismType & a_migrant)
+        {
+            OrganismType * migrant = new OrganismType(a_migrant);
+
+            if (m_mailboxes[a_island]->try_push(migrant))
+                return true;
+
+            delete migrant;
+            return false;
+        }
+
+        //! Receive a migrant
+        virtual bool collect(size_t a_island, vector<OrganismType> & a_arrivals)
+        {
+            OrganismType * migrant = NULL;
+
+            if (!m_mailboxes[a_island]->try_pop(migrant))
+                return false;
+
+            a_arrivals.push_back(*migrant);
+            delete migrant;
+            return true;
+        }
+
+        //! Get the shared status
+        virtual migration_status & status()
+        {
+            return m_status;
+        }
+
+    private:
+        // not copyable
+        queue_channel(const queue_channel &);
+        queue_channel & operator = (const queue_channel &);
+
+        // a mailbox per island
+        vector< std::unique_ptr< mpmc_queue<OrganismType *> > > m_mailboxes;
+
+        // shared status
+        migration_status m_status;
+    };
+
+    //! Runs several evocosms as islands that exchange migrants
+    /*!
+        The island model: each island is an ordinary evocosm, with its own
+        population and components, evolving on its own thread. Every few
+        generations, each island sends copies of some of its organisms to
+        its neighbours, as defined by a topology; arriving migrants replace
+        the island's worst organisms. Isolated populations explore
+        different parts of a landscape, while migration spreads good genes
+        between them.
+        <p>
+        Each island's migrants arrive in a lock-free mailbox, provided by a
+        migration_channel; the archipelago's own channel links threads, and
+        process_archipelago (shm_migration.h) links processes. Sending never
+        waits; if a mailbox is full, the migrant is dropped (and counted).
+        An island takes in whatever migrants have arrived each generation,
+        so islands never wait for each other.
+        <p>
+        Migration happens inside each generation, through the island's
+        test_hook: after the population has been tested, and before it is
+        analyzed, scaled, and selected from. Migrants are thus chosen, and
+        the worst organisms identified, by fitness computed for them, and
+        arrivals (carrying the fitness their home island gave them) compete
+        in selection at once. A test hook the island already had is called
+        after migration, and restored when the run ends.
+        <p>
+        Each island thread seeds its own random number generator with a
+        distinct stream derived from the archipelago's seed. The components
+        of an island are only called from that island's thread, and need
+        not be thread-safe, but islands must not share components that have
+        state. When any island's analyzer ends its run, the others stop at
+        the end of their current generation.
+        <p>
+        On a multi-socket host, set_node_binding keeps each island on one
+        NUMA node: its thread is bound to the node, and copies its
+        population before the first generation, so the organisms live in
+        that node's memory. Neighbouring islands share a node where they
+        can, so migration is the only work that crosses nodes. On a host
+        with one node, binding does nothing.
+        <p>
+        Programs using this class must be compiled and linked with thread
+        support (e.g., <i>-pthread</i>).
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class archipelago : protected globals
+    {
+    public:
+        //! How islands are connected
+        enum topology
+        {
+            TOPOLOGY_RING,  //!< Each island sends to the next, the last to the first
+            TOPOLOGY_TORUS, //!< Islands form a grid that wraps at the edges; each sends to four neighbours
+            TOPOLOGY_FULL   //!< Each island sends to every other
+        };
+
+        //! Which organisms emigrate
+        enum migration_policy
+        {
+            MIGRATE_BEST,   //!< The fittest organisms; they replace the worst at their destination
+            MIGRATE_RANDOM  //!< Randomly-chosen organisms; they replace the worst at their destination
+        };
+
+        //! Creation constructor
+        /*!
+            \param a_islands - The islands; the evocosms must outlive the archipelago
+            \param a_topology - How islands are connected
+            \param a_interval - Generations between migrations
+            \param a_migrants - Organisms each island sends to each neighbour
+            \param a_policy - Which organisms emigrate
+            \param a_seed - Seed from which each island's random stream is derived
+        */
+        archipelago(const vector<evocosm<OrganismType> *> & a_islands,
+                    topology                                a_topology = TOPOLOGY_RING,
+                    size_t                                  a_interval = 10,
+                    size_t                                  a_migrants = 1,
+                    migration_policy                        a_policy = MIGRATE_BEST,
+                    unsigned long long int                  a_seed = (unsigned long long int)(time(nullptr)));
+
+        //! Run the islands
+        /*!
+            Runs every island for a number of generations on its own thread,
+            and waits for them. If an island throws an exception, the others
+            are stopped and the exception is rethrown here.
+            \param a_generations - Maximum number of generations per island
+            \return <b>true</b> if every island ran all its generations, <b>false</b> if any was stopped
+        */
+        bool run(size_t a_generations);
+
+        //! Get the number of islands
+        size_t size() const
+        {
+            return m_islands.size();
+        }
+
+        //! Get the islands an island sends migrants to
+        /*!
+            \param a_island - Index of an island
+            \return Indexes of its neighbours
+        */
+        const vector<size_t> & get_neighbours(size_t a_island) const
+        {
+            return m_neighbours[a_island];
+        }
+
+        //! Get the number of migrants delivered
+        size_t get_migrants_sent() const
+        {
+            return static_cast<size_t>(m_channel->status().sent.load(std::memory_order_relaxed));
+        }
+
+        //! Get the number of migrants dropped because a mailbox was full
+        size_t get_migrants_dropped() const
+        {
+            return static_cast<size_t>(m_channel->status().dropped.load(std::memory_order_relaxed));
+        }
+
+        //! Keep each island on a NUMA node
+        /*!
+            Takes effect at the next run. Islands are spread over the nodes
+            in contiguous blocks, so island i runs on node
+            i * nodes / islands.
+            \param a_bind - <b>true</b> to bind island threads to nodes
+        */
+        void set_node_binding(bool a_bind)
+        {
+            m_bind_nodes = a_bind;
+        }
+
+        //! Are islands bound to NUMA nodes?
+        bool get_node_binding() const
+        {
+            return m_bind_nodes;
+        }
+
+        //! Get the node an island runs on when bound
+        /*!
+            \param a_island - Index of an island
+            \return Index of its node in numa_topology::host()
+        */
+        size_t get_node(size_t a_island) const
+        {
+            return a_island * numa_topology::host().node_count() / m_islands.size();
+        }
+
+    protected:
+        //! Evolve one island
+        /*!
+            Runs an island on the calling thread, migrating through the
+            current channel. Exceptions are caught and kept for run.
+            \param a_island - Index of the island
+            \param a_generations - Maximum number of generations
+            \return <b>false</b> if the island threw an exception
+        */
+        bool run_island(size_t a_island, size_t a_generations);
+
+        //! The islands
+        vector<evocosm<OrganismType> *> m_islands;
+
+        //! Channel in use; the archipelago's own, unless a derived class substitutes another
+        migration_channel<OrganismType> * m_channel;
+
+    private:
+        // not copyable
+        archipelago(const archipelago &);
+        archipelago & operator = (const archipelago &);
+
+        // migrates an island's organisms once they have been tested
+        class migration_hook : public test_hook<OrganismType>
+        {
+        public:
+            migration_hook(archipelago & a_owner, size_t a_island, test_hook<OrganismType> * a_next)
+              : m_owner(a_owner),
+                m_island(a_island),
+                m_next(a_next),
+                m_generation(0)
+            {
+                // nada
+            }
+
+            virtual void tested(vector<OrganismType> & a_population, size_t a_iteration)
+            {
+                ++m_generation;
+
+                if (m_generation % m_owner.m_interval == 0)
+                    m_owner.emigrate(m_island);
+
+                m_owner.immigrate(m_island);
+
+                // a hook the island already had still runs, after migration
+                if (m_next != NULL)
+                    m_next->tested(a_population, a_iteration);
+            }
+
+        private:
+            archipelago & m_owner;
+            size_t m_island;
+            test_hook<OrganismType> * m_next;
+            size_t m_generation;
+        };
+
+        // send migrants to an island's neighbours
+        void emigrate(size_t a_island);
+
+        // replace an island's worst organisms with arrivals
+        void immigrate(size_t a_island);
+
+        // give the calling thread its own random stream
+        void seed_stream(size_t a_island);
+
+        // bind the calling thread to an island's node, and move the island's organisms there
+        void localize(size_t a_island);
+
+        // where each island sends migrants
+        vector< vector<size_t> > m_neighbours;
+
+        // mailboxes for islands on threads
+        std::unique_ptr< queue_channel<OrganismType> > m_queues;
+
+        // generations between migrations
+        size_t m_interval;
+
+        // migrants per neighbour
+        size_t m_migrants;
+
+        // choice of emigrants
+        migration_policy m_policy;
+
+        // root of the random streams
+        unsigned long long int m_seed;
+
+        // keep islands on NUMA nodes?
+        bool m_bind_nodes;
+
+        // first exception thrown by an island
+        std::exception_ptr m_error;
+        std::atomic<bool> m_failed;
+    };
+
+    // constructor
+    template <class OrganismType>
+    archipelago<OrganismType>::archipelago(const vector<evocosm<OrganismType> *> & a_islands,
+                                           topology                                a_topology,
+                                           size_t                                  a_interval,
+                                           size_t                                  a_migrants,
+                                           migration_policy                        a_policy,
+                                           unsigned long long int                  a_seed)
+      : m_islands(a_islands),
+        m_channel(NULL),
+        m_neighbours(a_islands.size()),
+        m_queues(),
+        m_interval(a_interval > 0 ? a_interval : 1),
+        m_migrants(a_migrants),
+        m_policy(a_policy),
+        m_seed(a_seed),
+        m_bind_nodes(false),
+        m_error(),
+        m_failed(false)
+    {
+        size_t count = m_islands.size();
+
+        if (count == 0)
+            throw std::runtime_error("an archipelago needs at least one island");
+
+        switch (a_topology)
+        {
+            case TOPOLOGY_RING:
+                if (count > 1)
+                {
+                    for (size_t i = 0; i < count; ++i)
+                        m_neighbours[i].push_back((i + 1) % count);
+                }
+                break;
+
+            case TOPOLOGY_TORUS:
+            {
+                // the squarest grid that holds every island
+                size_t columns = 1;
+
+                for (size_t c = 1; c * c <= count; ++c)
+                {
+                    if (count % c == 0)
+                        columns = c;
+                }
+
+                size_t rows = count / columns;
+
+                for (size_t i = 0; i < count; ++i)
+                {
+                    size_t r = i / columns;
+                    size_t c = i % columns;
+
+                    size_t candidates[4] =
+                    {
+                        ((r + rows - 1) % rows) * columns + c,
+                        ((r + 1) % rows) * columns + c,
+                        r * columns + (c + columns - 1) % columns,
+                        r * columns + (c + 1) % columns
+                    };
+
+                    // small grids wrap onto themselves
+                    for (size_t n = 0; n < 4; ++n)
+                    {
+                        if ((candidates[n] != i) && (std::find(m_neighbours[i].begin(), m_neighbours[i].end(), candidates[n]) == m_neighbours[i].end()))
+                            m_neighbours[i].push_back(candidates[n]);
+                    }
+                }
+
+                break;
+            }
+
+            case TOPOLOGY_FULL:
+                for (size_t i = 0; i < count; ++i)
+                {
+                    for (size_t j = 0; j < count; ++j)
+                    {
+                        if (j != i)
+                            m_neighbours[i].push_back(j);
+                    }
+                }
+                break;
+        }
+
+        // room for a few migrations' worth of arrivals from every sender
+        vector<size_t> senders(count, 0);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t n = 0; n < m_neighbours[i].size(); ++n)
+                ++senders[m_neighbours[i][n]];
+        }
+
+        for (size_t i = 0; i < count; ++i)
+            senders[i] = 4 * m_migrants * (senders[i] > 0 ? senders[i] : 1);
+
+        m_queues.reset(new queue_channel<OrganismType>(senders));
+        m_channel = m_queues.get();
+    }
+
+    // run every island
+    template <class OrganismType>
+    bool archipelago<OrganismType>::run(size_t a_generations)
+    {
+        m_channel->status().stop.store(false);
+        m_failed.store(false);
+        m_error = std::exception_ptr();
+
+        vector<std::thread> threads;
+
+        for (size_t i = 0; i < m_islands.size(); ++i)
+            threads.push_back(std::thread(&archipelago::run_island, this, i, a_generations));
+
+        for (size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+
+        if (m_error)
+            std::rethrow_exception(m_error);
+
+        return !m_channel->status().stop.load();
+    }
+
+    // one island's evolution
+    template <class OrganismType>
+    bool archipelago<OrganismType>::run_island(size_t a_island, size_t a_generations)
+    {
+        std::atomic<bool> & stop = m_channel->status().stop;
+        evocosm<OrganismType> & island = *m_islands[a_island];
+
+        // migration ranks organisms by fitness, so it happens between testing and selection
+        test_hook<OrganismType> * previous = island.get_test_hook();
+        migration_hook hook(*this, a_island, previous);
+        island.set_test_hook(&hook);
+
+        try
+        {
+            seed_stream(a_island);
+
+            if (m_bind_nodes)
+                localize(a_island);
+
+            for (size_t g = 1; (g <= a_generations) && !stop.load(std::memory_order_relaxed); ++g)
+            {
+                if (!island.run_generation())
+                {
+                    stop.store(true);
+                    break;
+                }
+            }
+        }
+        catch (...)
+        {
+            island.set_test_hook(previous);
+
+            // keep the first error
+            if (!m_failed.exchange(true))
+                m_error = std::current_exception();
+
+            stop.store(true);
+            return false;
+        }
+
+        island.set_test_hook(previous);
+        return true;
+    }
+
+    // send copies of organisms to neighbours
+    template <class OrganismType>
+    void archipelago<OrganismType>::emigrate(size_t a_island)
+    {
+        vector<OrganismType> & population = m_islands[a_island]->get_population();
+        size_t count = std::min(m_migrants, population.size());
+
+        if ((count == 0) || m_neighbours[a_island].empty())
+            return;
+
+        vector<size_t> chosen(count);
+
+        if (m_policy == MIGRATE_BEST)
+        {
+            vector<size_t> order(population.size());
+
+            for (size_t n = 0; n < order.size(); ++n)
+                order[n] = n;
+
+            std::partial_sort(order.begin(), order.begin() + count, order.end(),
+                              [&population](size_t a, size_t b) { return population[a].fitness > population[b].fitness; });
+
+            std::copy(order.begin(), order.begin() + count, chosen.begin());
+        }
+        else
+        {
+            for (size_t n = 0; n < count; ++n)
+                chosen[n] = g_random.get_index(population.size());
+        }
+
+        size_t sent = 0;
+        size_t dropped = 0;
+
+        for (size_t i = 0; i < m_neighbours[a_island].size(); ++i)
+        {
+            for (size_t n = 0; n < count; ++n)
+            {
+                if (m_channel->post(m_neighbours[a_island][i], population[chosen[n]]))
+                    ++sent;
+                else
+                    ++dropped;
+            }
+        }
+
+        m_channel->status().sent.fetch_add(sent, std::memory_order_relaxed);
+        m_channel->status().dropped.fetch_add(dropped, std::memory_order_relaxed);
+    }
+
+    // take in arrivals
+    template <class OrganismType>
+    void archipelago<OrganismType>::immigrate(size_t a_island)
+    {
+        vector<OrganismType> & population = m_islands[a_island]->get_population();
+        vector<OrganismType> arrivals;
+
+        while ((arrivals.size() < population.size()) && m_channel->collect(a_island, arrivals))
+        {
+            // nada
+        }
+
+        if (arrivals.empty())
+            return;
+
+        // the worst organisms make room
+        vector<size_t> order(population.size());
+
+        for (size_t n = 0; n < order.size(); ++n)
+            order[n] = n;
+
+        std::partial_sort(order.begin(), order.begin() + arrivals.size(), order.end(),
+                          [&population](size_t a, size_t b) { return population[a].fitness < population[b].fitness; });
+
+        for (size_t n = 0; n < arrivals.size(); ++n)
+            population[order[n]] = arrivals[n];
+    }
+
+    // first-touch the island's organisms from its node
+    template <class OrganismType>
+    void archipelago<OrganismType>::localize(size_t a_island)
+    {
+        if (!numa_topology::host().bind_thread(get_node(a_island)))
+            return;
+
+        vector<OrganismType> & population = m_islands[a_island]->get_population();
+        vector<OrganismType> local(population);
+        population.swap(local);
+        local.clear();
+
+        // the old memory belongs to another node; don't let the pool hand it out again
+        genome_pool::release();
+    }
+
+    // a distinct stream per island
+    template <class OrganismType>
+    void archipelago<OrganismType>::seed_stream(size_t a_island)
+    {
+        // seeding expands this through splitmix64 over the generator's state
+        g_random.set_seed(m_seed + 0x9E3779B97F4A7C15ULL * (a_island + 1));
+    }
+};
+
+#endif
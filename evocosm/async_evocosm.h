@@ -0,0 +1,397 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_ASYNC_EVOCOSM_H)
+#define LIBEVOCOSM_ASYNC_EVOCOSM_H
+
+// Standard C++ library
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// libevocosm
+#include "steady_state.h"
+#include "mpmc_queue.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! An asynchronous, master-worker evocosm
+    /*!
+        When fitness tests take wildly different amounts of time, a
+        generational evocosm leaves processors idle while it waits for the
+        slowest test. An async_evocosm keeps a fixed pool of worker threads
+        busy instead. The calling (master) thread breeds candidates and hands
+        them to the workers through a lock-free queue; as each test finishes,
+        the master inserts the result into the population, as in a
+        steady_state_evocosm, and immediately breeds a replacement
+        candidate. The number of candidates in flight is bounded, so
+        children are never bred from a population that is too far out of
+        date. The initial population is tested by the workers too, before
+        the first candidate is bred.
+        <p>
+        Only the master thread calls the reproducer, mutator, and analyzer,
+        so those components need not be thread-safe. Workers call
+        <i>landscape::test</i> on a single organism, and the listener's
+        <i>ping_fitness_test_begin</i> and <i>ping_fitness_test_end</i>,
+        concurrently; those must be safe to call from several threads at
+        once. An exception thrown by any of them is carried back to the
+        master thread, and rethrown from run_step. Each worker thread has its own prng, which set_seed does not
+        reach, so a landscape that draws random numbers will not repeat its
+        results from one run to the next.
+        <p>
+        Programs using this class must be compiled and linked with thread
+        support (e.g., <i>-pthread</i>).
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class async_evocosm : public steady_state_evocosm<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            Creates a new asynchronous evocosm. Worker threads start with the
+            first step, and stop when the evocosm is destroyed.
+            \param a_population - Initial population of organisms
+            \param a_landscape - Tests organism fitness
+            \param a_mutator - A concrete implementation of mutator
+            \param a_reproducer - A concrete implementation of reproducer
+            \param a_analyzer - A concrete implementation of analyzer
+            \param a_listener - A listener for events
+            \param a_workers - Number of worker threads; zero means one per hardware thread
+            \param a_in_flight - Maximum number of candidates being tested at once; zero means twice the workers
+            \param a_policy - How results replace existing organisms
+            \param a_tournament_size - Organisms in each replacement tournament
+        */
+        async_evocosm(vector<OrganismType> &     a_population,
+                      landscape<OrganismType> &  a_landscape,
+                      mutator<OrganismType> &    a_mutator,
+                      reproducer<OrganismType> & a_reproducer,
+                      analyzer<OrganismType> &   a_analyzer,
+                      listener<OrganismType> &   a_listener,
+                      size_t                     a_workers = 0,
+                      size_t                     a_in_flight = 0,
+                      typename steady_state_evocosm<OrganismType>::replacement_policy a_policy = steady_state_evocosm<OrganismType>::REPLACE_TOURNAMENT,
+                      size_t                     a_tournament_size = 2);
+
+        //! Destructor
+        /*!
+            Stops and joins the worker threads; candidates still in flight
+            are discarded.
+        */
+        virtual ~async_evocosm();
+
+        //! Wait for one result and insert it
+        /*!
+            Keeps the workers supplied with candidates, then waits for one
+            test to finish and puts the result into the population. The
+            first call starts the workers, and has them test the initial
+            population.
+            <p>
+            If a test threw, the exception is rethrown here; the candidate
+            is discarded, and the evocosm can go on with another step. An
+            exception while testing the initial population is rethrown once
+            every test has finished, and the next step tests it over.
+        */
+        virtual void run_step();
+
+        //! Get the number of worker threads
+        size_t get_workers() const
+        {
+            return m_workers;
+        }
+
+        //! Get the limit on candidates in flight
+        size_t get_in_flight_limit() const
+        {
+            return m_in_flight_limit;
+        }
+
+    protected:
+        using steady_state_evocosm<OrganismType>::m_population;
+        using steady_state_evocosm<OrganismType>::m_landscape;
+        using steady_state_evocosm<OrganismType>::m_mutator;
+        using steady_state_evocosm<OrganismType>::m_reproducer;
+        using steady_state_evocosm<OrganismType>::m_listener;
+        using steady_state_evocosm<OrganismType>::m_births;
+        using steady_state_evocosm<OrganismType>::m_tested;
+
+    private:
+        // not copyable
+        async_evocosm(const async_evocosm &);
+        async_evocosm & operator = (const async_evocosm &);
+
+        // launch workers
+        void start();
+
+        // body of a worker thread
+        void work();
+
+        // have the workers test the whole population
+        void test_population();
+
+        // back off while waiting on a queue: yield at first, then sleep briefly
+        static void idle(size_t & a_spins)
+        {
+            if (++a_spins < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+
+        // number of worker threads
+        size_t m_workers;
+
+        // most candidates being tested at once
+        size_t m_in_flight_limit;
+
+        // candidates being tested
+        size_t m_in_flight;
+
+        // storage for candidates; the queues carry indexes into this
+        vector<OrganismType> m_slots;
+
+        // exception thrown while testing the candidate in each slot
+        vector<std::exception_ptr> m_errors;
+
+        // slots not in flight; only touched by the master
+        vector<size_t> m_free_slots;
+
+        // candidates waiting for a worker
+        mpmc_queue<size_t> m_pending;
+
+        // tested candidates waiting for the master
+        mpmc_queue<size_t> m_completed;
+
+        // the worker pool
+        vector<std::thread> m_threads;
+
+        // tells workers to quit
+        std::atomic<bool> m_stop;
+    };
+
+    // constructor
+    template <class OrganismType>
+    async_evocosm<OrganismType>::async_evocosm(vector<OrganismType> &     a_population,
+                                               landscape<OrganismType> &  a_landscape,
+                                               mutator<OrganismType> &    a_mutator,
+                                               reproducer<OrganismType> & a_reproducer,
+                                               analyzer<OrganismType> &   a_analyzer,
+                                               listener<OrganismType> &   a_listener,
+                                               size_t                     a_workers,
+                                               size_t                     a_in_flight,
+                                               typename steady_state_evocosm<OrganismType>::replacement_policy a_policy,
+                                               size_t                     a_tournament_size)
+      : steady_state_evocosm<OrganismType>(a_population, a_landscape, a_mutator, a_reproducer, a_analyzer, a_listener, a_policy, a_tournament_size),
+        m_workers(a_workers > 0 ? a_workers : (std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1)),
+        m_in_flight_limit(a_in_flight > 0 ? a_in_flight : 2 * m_workers),
+        m_in_flight(0),
+        m_slots(),
+        m_errors(),
+        m_free_slots(),
+        m_pending(m_in_flight_limit),
+        m_completed(m_in_flight_limit),
+        m_threads(),
+        m_stop(false)
+    {
+        // nada
+    }
+
+    // destructor
+    template <class OrganismType>
+    async_evocosm<OrganismType>::~async_evocosm()
+    {
+        m_stop.store(true, std::memory_order_release);
+
+        for (size_t n = 0; n < m_threads.size(); ++n)
+            m_threads[n].join();
+    }
+
+    // launch workers
+    template <class OrganismType>
+    void async_evocosm<OrganismType>::start()
+    {
+        // slots are initialized by copying, since organisms needn't have default constructors
+        m_slots.assign(m_in_flight_limit, m_population[0]);
+        m_errors.assign(m_in_flight_limit, std::exception_ptr());
+        m_free_slots.clear();
+
+        for (size_t n = 0; n < m_in_flight_limit; ++n)
+            m_free_slots.push_back(n);
+
+        for (size_t n = 0; n < m_workers; ++n)
+            m_threads.push_back(std::thread(&async_evocosm<OrganismType>::work, this));
+    }
+
+    // worker thread
+    template <class OrganismType>
+    void async_evocosm<OrganismType>::work()
+    {
+        size_t slot;
+        size_t spins = 0;
+
+        while (!m_stop.load(std::memory_order_acquire))
+        {
+            if (m_pending.try_pop(slot))
+            {
+                spins = 0;
+
+                OrganismType & candidate = m_slots[slot];
+
+                try
+                {
+                    m_listener.ping_fitness_test_begin(candidate);
+                    candidate.fitness = m_landscape.test(candidate);
+                    m_listener.ping_fitness_test_end(candidate);
+                }
+                catch (...)
+                {
+                    // the queue publishes this to the master along with the slot
+                    m_errors[slot] = std::current_exception();
+                }
+
+                // the completed queue holds every slot, so this can't fail
+                m_completed.try_push(slot);
+            }
+            else
+                idle(spins);
+        }
+    }
+
+    // test the whole population on the workers
+    template <class OrganismType>
+    void async_evocosm<OrganismType>::test_population()
+    {
+        // the population index each slot holds
+        vector<size_t> owners(m_slots.size());
+
+        size_t next = 0;
+        size_t done = 0;
+        size_t spins = 0;
+
+        // the first exception; once there is one, only outstanding tests are waited for
+        std::exception_ptr error;
+
+        while (done < next || (!error && (next < m_population.size())))
+        {
+            while (!error && (next < m_population.size()) && !m_free_slots.empty())
+            {
+                size_t slot = m_free_slots.back();
+                m_free_slots.pop_back();
+
+                m_slots[slot] = m_population[next];
+                owners[slot] = next++;
+                m_pending.try_push(slot);
+            }
+
+            size_t slot;
+
+            if (m_completed.try_pop(slot))
+            {
+                spins = 0;
+
+                if (m_errors[slot])
+                {
+                    if (!error)
+                        error = m_errors[slot];
+
+                    m_errors[slot] = std::exception_ptr();
+                }
+                else
+                {
+                    // the whole organism, since a test may set more than fitness
+                    m_population[owners[slot]] = m_slots[slot];
+                }
+
+                m_free_slots.push_back(slot);
+                ++done;
+            }
+            else
+                idle(spins);
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // wait for and insert one result
+    template <class OrganismType>
+    void async_evocosm<OrganismType>::run_step()
+    {
+        if (m_population.empty())
+            return;
+
+        if (m_threads.empty())
+            start();
+
+        // the initial population needs fitness values before anyone can breed
+        if (!m_tested)
+        {
+            test_population();
+            m_tested = true;
+        }
+
+        // keep the workers busy
+        while (!m_free_slots.empty())
+        {
+            // children are numbered in the order they are bred, which runs ahead of births
+            size_t child = m_births + m_in_flight;
+
+            this->g_random.set_stream(child, 0, STREAM_BREED);
+            vector<OrganismType> children = m_reproducer.breed(m_population, 1);
+
+            if (children.empty())
+                break;
+
+            this->g_random.set_stream(child, 0, STREAM_MUTATE);
+            m_mutator.mutate(children);
+
+            size_t slot = m_free_slots.back();
+            m_free_slots.pop_back();
+
+            m_slots[slot] = children[0];
+            m_pending.try_push(slot);
+            ++m_in_flight;
+        }
+
+        if (m_in_flight == 0)
+            return;
+
+        // wait for a result
+        size_t slot;
+        size_t spins = 0;
+
+        while (!m_completed.try_pop(slot))
+            idle(spins);
+
+        m_free_slots.push_back(slot);
+        --m_in_flight;
+
+        if (m_errors[slot])
+        {
+            std::exception_ptr error = m_errors[slot];
+            m_errors[slot] = std::exception_ptr();
+            std::rethrow_exception(error);
+        }
+
+        m_population[this->choose_loser()] = m_slots[slot];
+        ++m_births;
+    }
+};
+
+#endif
@@ -0,0 +1,711 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_ASYNC_LANDSCAPE_H)
+#define LIBEVOCOSM_ASYNC_LANDSCAPE_H
+
+// The rest of Evocosm is C++14; only programs that include this header
+// need a compiler in C++20 mode (e.g., -std=c++20)
+#if !defined(__cpp_impl_coroutine)
+#error "async_landscape.h requires C++20 coroutines"
+#else
+
+// Standard C++ Library
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// POSIX
+#include <poll.h>
+
+// libevocosm
+#include "listener.h"
+#include "landscape.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    template <typename Type> class task;
+
+    //! Parts of a task's promise that don't depend on its result
+    class task_promise_base
+    {
+    public:
+        //! Tasks start when they are awaited or spawned
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        //! Resumes the awaiting coroutine, if any, when a task finishes
+        struct final_awaiter
+        {
+            //! Always suspend
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            //! Transfer to the continuation
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> a_handle) noexcept
+            {
+                std::coroutine_handle<> next = a_handle.promise().m_continuation;
+                return next ? next : std::noop_coroutine();
+            }
+
+            //! Nothing to return
+            void await_resume() noexcept
+            {
+                // nada
+            }
+        };
+
+        //! Suspend at the end, so the result can be read
+        final_awaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        //! Keep an exception for whoever reads the result
+        void unhandled_exception()
+        {
+            m_error = std::current_exception();
+        }
+
+        //! Coroutine waiting for this one
+        std::coroutine_handle<> m_continuation;
+
+        //! Exception thrown by the task
+        std::exception_ptr m_error;
+    };
+
+    //! Promise of a task that produces a value
+    template <typename Type>
+    class task_promise : public task_promise_base
+    {
+    public:
+        //! Create the task
+        task<Type> get_return_object();
+
+        //! Store the result
+        void return_value(Type a_value)
+        {
+            m_value = std::move(a_value);
+        }
+
+        //! Get the result, or rethrow the task's exception
+        Type result()
+        {
+            if (m_error)
+                std::rethrow_exception(m_error);
+
+            return std::move(m_value);
+        }
+
+    private:
+        // the result
+        Type m_value;
+    };
+
+    //! Promise of a task that produces no value
+    template <>
+    class task_promise<void> : public task_promise_base
+    {
+    public:
+        //! Create the task
+        task<void> get_return_object();
+
+        //! Nothing to store
+        void return_void()
+        {
+            // nada
+        }
+
+        //! Rethrow the task's exception, if any
+        void result()
+        {
+            if (m_error)
+                std::rethrow_exception(m_error);
+        }
+    };
+
+    //! A lazily-started coroutine that produces a value
+    /*!
+        A task does nothing until it is awaited (with <i>co_await</i>) by
+        another coroutine, or spawned on an event_loop. When it finishes,
+        the awaiting coroutine resumes at once with its result. A task owns
+        its coroutine, and can be moved but not copied.
+        \param Type - The type of result; <i>void</i> for none
+    */
+    template <typename Type>
+    class task
+    {
+    public:
+        //! The coroutine's promise
+        typedef task_promise<Type> promise_type;
+
+        //! Creation constructor
+        /*!
+            \param a_handle - The coroutine; the task takes ownership
+        */
+        explicit task(std::coroutine_handle<promise_type> a_handle)
+          : m_handle(a_handle)
+        {
+            // nada
+        }
+
+        //! Move constructor
+        task(task && a_source) noexcept
+          : m_handle(std::exchange(a_source.m_handle, nullptr))
+        {
+            // nada
+        }
+
+        //! Move assignment
+        task & operator = (task && a_source) noexcept
+        {
+            if (this != &a_source)
+            {
+                if (m_handle)
+                    m_handle.destroy();
+
+                m_handle = std::exchange(a_source.m_handle, nullptr);
+            }
+
+            return *this;
+        }
+
+        //! Destructor
+        ~task()
+        {
+            if (m_handle)
+                m_handle.destroy();
+        }
+
+        //! Has the task finished?
+        bool done() const
+        {
+            return !m_handle || m_handle.done();
+        }
+
+        //! Get the result of a finished task
+        /*!
+            Rethrows any exception the task threw.
+        */
+        Type get()
+        {
+            return m_handle.promise().result();
+        }
+
+        //! Get the coroutine
+        std::coroutine_handle<> handle() const
+        {
+            return m_handle;
+        }
+
+        //! Awaiting a task starts it
+        bool await_ready() const noexcept
+        {
+            return done();
+        }
+
+        //! Start the task, resuming the awaiting coroutine when it finishes
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> a_awaiting) noexcept
+        {
+            m_handle.promise().m_continuation = a_awaiting;
+            return m_handle;
+        }
+
+        //! The task's result
+        Type await_resume()
+        {
+            return m_handle.promise().result();
+        }
+
+    private:
+        // not copyable
+        task(const task &) = delete;
+        task & operator = (const task &) = delete;
+
+        // the coroutine
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    // create a task
+    template <typename Type>
+    task<Type> task_promise<Type>::get_return_object()
+    {
+        return task<Type>(std::coroutine_handle< task_promise<Type> >::from_promise(*this));
+    }
+
+    // create a task
+    inline task<void> task_promise<void>::get_return_object()
+    {
+        return task<void>(std::coroutine_handle< task_promise<void> >::from_promise(*this));
+    }
+
+    //! Runs coroutines on one thread
+    /*!
+        Coroutines suspended on an event_loop wait for a turn (yield), a
+        time (sleep_for), or a file descriptor (readable, writable). The
+        loop resumes each when it is ready; while every coroutine waits, the
+        thread sleeps in <i>poll</i>. Thousands of coroutines can wait on
+        one thread.
+        <p>
+        The loop running on the current thread is available from current,
+        so coroutines needn't pass it around. An event_loop is used from
+        one thread only.
+    */
+    class event_loop
+    {
+    public:
+        //! Constructor
+        event_loop()
+          : m_ready(),
+            m_timers(),
+            m_waits(),
+            m_spawned(),
+            m_sequence(0)
+        {
+            // nada
+        }
+
+        //! Get the loop running on this thread
+        /*!
+            \return The loop, or <b>NULL</b> outside of run
+        */
+        static event_loop * current()
+        {
+            return current_slot();
+        }
+
+        //! Schedule a coroutine to resume
+        void post(std::coroutine_handle<> a_handle)
+        {
+            m_ready.push_back(a_handle);
+        }
+
+        //! Start a task
+        /*!
+            The loop keeps the task until run returns.
+            \param a_task - The task
+        */
+        void spawn(task<void> && a_task)
+        {
+            post(a_task.handle());
+            m_spawned.push_back(std::move(a_task));
+        }
+
+        //! Awaitable that lets other coroutines run
+        struct yield_awaiter
+        {
+            event_loop & m_loop;
+
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> a_handle)
+            {
+                m_loop.post(a_handle);
+            }
+
+            void await_resume() noexcept
+            {
+                // nada
+            }
+        };
+
+        //! Awaitable that resumes after a time
+        struct timer_awaiter
+        {
+            event_loop & m_loop;
+            std::chrono::steady_clock::time_point m_when;
+
+            bool await_ready() noexcept
+            {
+                return std::chrono::steady_clock::now() >= m_when;
+            }
+
+            void await_suspend(std::coroutine_handle<> a_handle)
+            {
+                m_loop.m_timers.push(timer(m_when, m_loop.m_sequence++, a_handle));
+            }
+
+            void await_resume() noexcept
+            {
+                // nada
+            }
+        };
+
+        //! Awaitable that resumes when a file descriptor is ready
+        struct io_awaiter
+        {
+            event_loop & m_loop;
+            int m_fd;
+            short m_events;
+
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> a_handle)
+            {
+                m_loop.m_waits.push_back(io_wait(m_fd, m_events, a_handle));
+            }
+
+            void await_resume() noexcept
+            {
+                // nada
+            }
+        };
+
+        //! Let other coroutines run
+        yield_awaiter yield()
+        {
+            return yield_awaiter{ *this };
+        }
+
+        //! Wait for a time
+        /*!
+            \param a_delay - How long to wait
+        */
+        timer_awaiter sleep_for(std::chrono::nanoseconds a_delay)
+        {
+            return timer_awaiter{ *this, std::chrono::steady_clock::now() + a_delay };
+        }
+
+        //! Wait until a file descriptor can be read, or is closed
+        io_awaiter readable(int a_fd)
+        {
+            return io_awaiter{ *this, a_fd, POLLIN };
+        }
+
+        //! Wait until a file descriptor can be written
+        io_awaiter writable(int a_fd)
+        {
+            return io_awaiter{ *this, a_fd, POLLOUT };
+        }
+
+        //! Run until every coroutine has finished
+        /*!
+            Rethrows the first exception thrown by a spawned task, and throws
+            std::runtime_error if coroutines are left waiting on nothing.
+        */
+        void run();
+
+    private:
+        // not copyable
+        event_loop(const event_loop &) = delete;
+        event_loop & operator = (const event_loop &) = delete;
+
+        // this thread's loop
+        static event_loop *& current_slot()
+        {
+            static thread_local event_loop * loop = nullptr;
+            return loop;
+        }
+
+        // a sleeping coroutine
+        struct timer
+        {
+            std::chrono::steady_clock::time_point m_when;
+            unsigned long long int m_sequence;
+            std::coroutine_handle<> m_handle;
+
+            timer(std::chrono::steady_clock::time_point a_when, unsigned long long int a_sequence, std::coroutine_handle<> a_handle)
+              : m_when(a_when),
+                m_sequence(a_sequence),
+                m_handle(a_handle)
+            {
+                // nada
+            }
+
+            // earliest first; ties in the order they were set
+            bool operator < (const timer & a_right) const
+            {
+                return (m_when > a_right.m_when) || ((m_when == a_right.m_when) && (m_sequence > a_right.m_sequence));
+            }
+        };
+
+        // a coroutine waiting on a file descriptor
+        struct io_wait
+        {
+            int m_fd;
+            short m_events;
+            std::coroutine_handle<> m_handle;
+
+            io_wait(int a_fd, short a_events, std::coroutine_handle<> a_handle)
+              : m_fd(a_fd),
+                m_events(a_events),
+                m_handle(a_handle)
+            {
+                // nada
+            }
+        };
+
+        // coroutines ready to resume
+        std::deque< std::coroutine_handle<> > m_ready;
+
+        // sleeping coroutines
+        std::priority_queue<timer> m_timers;
+
+        // coroutines waiting on file descriptors
+        vector<io_wait> m_waits;
+
+        // tasks started by spawn
+        vector< task<void> > m_spawned;
+
+        // orders timers set for the same time
+        unsigned long long int m_sequence;
+    };
+
+    // run the loop
+    inline void event_loop::run()
+    {
+        event_loop * previous = current_slot();
+        current_slot() = this;
+
+        vector<pollfd> polls;
+
+        while (!m_ready.empty() || !m_timers.empty() || !m_waits.empty())
+        {
+            while (!m_ready.empty())
+            {
+                std::coroutine_handle<> handle = m_ready.front();
+                m_ready.pop_front();
+                handle.resume();
+            }
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+            // sleep until the next timer, or a file descriptor is ready
+            int timeout = -1;
+
+            if (!m_timers.empty())
+                timeout = (m_timers.top().m_when > now) ? static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(m_timers.top().m_when - now).count() + 1) : 0;
+
+            if (!m_waits.empty())
+            {
+                polls.resize(m_waits.size());
+
+                for (size_t n = 0; n < m_waits.size(); ++n)
+                {
+                    polls[n].fd      = m_waits[n].m_fd;
+                    polls[n].events  = m_waits[n].m_events;
+                    polls[n].revents = 0;
+                }
+
+                if (poll(polls.data(), polls.size(), timeout) > 0)
+                {
+                    // wake ready waiters, keeping the others in order
+                    size_t kept = 0;
+
+                    for (size_t n = 0; n < m_waits.size(); ++n)
+                    {
+                        if (polls[n].revents != 0)
+                            post(m_waits[n].m_handle);
+                        else
+                            m_waits[kept++] = m_waits[n];
+                    }
+
+                    m_waits.erase(m_waits.begin() + kept, m_waits.end());
+                }
+            }
+            else if (timeout > 0)
+                std::this_thread::sleep_until(m_timers.top().m_when);
+
+            now = std::chrono::steady_clock::now();
+
+            while (!m_timers.empty() && (m_timers.top().m_when <= now))
+            {
+                post(m_timers.top().m_handle);
+                m_timers.pop();
+            }
+        }
+
+        current_slot() = previous;
+
+        vector< task<void> > spawned;
+        spawned.swap(m_spawned);
+
+        for (size_t n = 0; n < spawned.size(); ++n)
+        {
+            if (!spawned[n].done())
+                throw std::runtime_error("event_loop stopped with coroutines still waiting");
+        }
+
+        for (size_t n = 0; n < spawned.size(); ++n)
+            spawned[n].get();
+    }
+
+    //! A landscape whose fitness tests are coroutines
+    /*!
+        For fitness tests that spend their time waiting (on simulators,
+        files, or local services) rather than computing. A derived class
+        implements test_async as a coroutine that suspends while it waits,
+        using the awaitables of event_loop::current(). Testing a population
+        keeps many tests in flight on each of a few threads, each thread
+        running its own event_loop.
+        <p>
+        To the rest of Evocosm, this is an ordinary landscape: an evocosm's
+        run_generation, or a steady_state_evocosm, calls test as usual.
+        <p>
+        With more than one thread, test_async is called from several
+        threads at once.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class async_landscape : public landscape<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_listener - A listener for events
+            \param a_in_flight - Most tests in progress at once on each thread
+            \param a_threads - Threads that share the tests of a population
+        */
+        async_landscape(listener<OrganismType> & a_listener, size_t a_in_flight = 256, size_t a_threads = 1)
+          : landscape<OrganismType>(a_listener),
+            m_in_flight(a_in_flight > 0 ? a_in_flight : 1),
+            m_threads(a_threads > 0 ? a_threads : 1)
+        {
+            // nada
+        }
+
+        //! Tests an organism, asynchronously
+        /*!
+            \param a_organism - The organism to be tested
+            \return A task that computes the organism's fitness
+        */
+        virtual task<double> test_async(OrganismType & a_organism) const = 0;
+
+        //! Performs fitness testing
+        /*!
+            Runs test_async for one organism to completion.
+            \param a_organism - The organism to be tested
+            \param a_verbose - Ignored
+            \return Computed fitness for this organism
+        */
+        virtual double test(OrganismType & a_organism, bool a_verbose = false) const
+        {
+            test_range(&a_organism, &a_organism + 1);
+            return a_organism.fitness;
+        }
+
+        //! Performs fitness testing
+        /*!
+            Tests every organism, with up to <i>in_flight</i> tests in
+            progress on each thread.
+            \param a_population - Organisms to be tested
+            \return Zero, as for the base class
+        */
+        virtual double test(vector<OrganismType> & a_population) const
+        {
+            size_t threads = std::min(m_threads, a_population.size());
+
+            if (threads <= 1)
+            {
+                test_range(a_population.data(), a_population.data() + a_population.size());
+                return 0.0;
+            }
+
+            // each thread takes a contiguous share of the population
+            vector<std::thread> workers;
+            vector<std::exception_ptr> errors(threads);
+            size_t share = (a_population.size() + threads - 1) / threads;
+
+            for (size_t t = 0; t < threads; ++t)
+            {
+                OrganismType * first = a_population.data() + std::min(t * share, a_population.size());
+                OrganismType * last  = a_population.data() + std::min((t + 1) * share, a_population.size());
+
+                workers.push_back(std::thread([this, first, last, &errors, t]()
+                {
+                    try
+                    {
+                        test_range(first, last);
+                    }
+                    catch (...)
+                    {
+                        errors[t] = std::current_exception();
+                    }
+                }));
+            }
+
+            for (size_t t = 0; t < threads; ++t)
+                workers[t].join();
+
+            for (size_t t = 0; t < threads; ++t)
+            {
+                if (errors[t])
+                    std::rethrow_exception(errors[t]);
+            }
+
+            return 0.0;
+        }
+
+    private:
+        // test organisms on this thread's loop
+        void test_range(OrganismType * a_first, OrganismType * a_last) const
+        {
+            event_loop loop;
+            OrganismType * next = a_first;
+            size_t drains = std::min(m_in_flight, static_cast<size_t>(a_last - a_first));
+
+            for (size_t n = 0; n < drains; ++n)
+                loop.spawn(drain(next, a_last));
+
+            loop.run();
+        }
+
+        // test organisms one after another, sharing the range with other drains
+        task<void> drain(OrganismType * & a_next, OrganismType * a_last) const
+        {
+            while (a_next != a_last)
+            {
+                OrganismType & organism = *a_next++;
+
+#if defined(EVOCOSM_METRICS)
+                uint64_t start = metrics_recorder::now();
+                organism.fitness = co_await test_async(organism);
+                metrics_recorder::record_evaluation(metrics_recorder::now() - start);
+#else
+                organism.fitness = co_await test_async(organism);
+#endif
+            }
+        }
+
+        // tests in flight per thread
+        size_t m_in_flight;
+
+        // threads per population
+        size_t m_threads;
+    };
+};
+
+#endif
+#endif
@@ -0,0 +1,168 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cstdio>
+
+#if !defined(_MSC_VER)
+#include <unistd.h>
+#endif
+
+#include "checkpoint.h"
+#include "evocommon.h"
+using namespace libevocosm;
+
+// identifies a checkpoint file
+static const char CHECKPOINT_MAGIC[8] = { 'E', 'V', 'O', 'C', 'K', 'P', 'T', '1' };
+
+// checkpoint file header
+struct checkpoint_header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t engine;
+    uint32_t random_words;
+    uint64_t length;
+};
+
+// 64-bit FNV-1a hash, to catch damaged files
+static uint64_t checksum(const vector<unsigned char> & a_data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t n = 0; n < a_data.size(); ++n)
+    {
+        hash ^= a_data[n];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// constructor
+checkpointer::checkpointer(const std::string & a_filename)
+  : m_filename(a_filename),
+    m_image(),
+    m_ok(true),
+    m_writer()
+{
+    // nada
+}
+
+// destructor
+checkpointer::~checkpointer()
+{
+    wait();
+}
+
+// start a background write
+void checkpointer::save(checkpoint_writer & a_image)
+{
+    wait();
+
+    m_image.swap(a_image.data());
+    a_image.data().clear();
+
+    m_writer = std::thread(&checkpointer::write_file, this);
+}
+
+// wait for a write
+bool checkpointer::wait()
+{
+    if (m_writer.joinable())
+        m_writer.join();
+
+    return m_ok;
+}
+
+// write to a temporary file, then rename it over the checkpoint
+void checkpointer::write_file()
+{
+    std::string temp_name = m_filename + ".tmp";
+
+    FILE * file = fopen(temp_name.c_str(), "wb");
+
+    if (file == NULL)
+    {
+        m_ok = false;
+        return;
+    }
+
+    checkpoint_header header;
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version      = VERSION;
+    header.flags        = 0;
+    header.engine       = prng::engine_type::ID;
+    header.random_words = static_cast<uint32_t>(prng::STATE_WORDS);
+    header.length       = m_image.size();
+
+    uint64_t sum = checksum(m_image);
+
+    bool ok = (fwrite(&header, sizeof(header), 1, file) == 1)
+           && (m_image.empty() || (fwrite(&m_image[0], m_image.size(), 1, file) == 1))
+           && (fwrite(&sum, sizeof(sum), 1, file) == 1)
+           && (fflush(file) == 0);
+
+#if !defined(_MSC_VER)
+    // the data must be on disk before the rename makes it the checkpoint
+    if (ok)
+        ok = (fsync(fileno(file)) == 0);
+#endif
+
+    ok = (fclose(file) == 0) && ok;
+
+    if (ok)
+        ok = (rename(temp_name.c_str(), m_filename.c_str()) == 0);
+    else
+        remove(temp_name.c_str());
+
+    m_ok = ok;
+}
+
+// read a checkpoint file
+void checkpointer::load(const std::string & a_filename, vector<unsigned char> & a_image)
+{
+    FILE * file = fopen(a_filename.c_str(), "rb");
+
+    if (file == NULL)
+        throw std::runtime_error("unable to open checkpoint " + a_filename);
+
+    checkpoint_header header;
+    uint64_t sum = 0;
+    bool ok = (fread(&header, sizeof(header), 1, file) == 1)
+           && (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0)
+           && (header.version == VERSION);
+
+    // the image holds the generator's state, which only the same engine can read
+    if (ok && ((header.engine != prng::engine_type::ID) || (header.random_words != prng::STATE_WORDS)))
+    {
+        fclose(file);
+        throw std::runtime_error("checkpoint " + a_filename + " was written with a different random engine");
+    }
+
+    if (ok)
+    {
+        a_image.resize(static_cast<size_t>(header.length));
+
+        ok = (a_image.empty() || (fread(&a_image[0], a_image.size(), 1, file) == 1))
+          && (fread(&sum, sizeof(sum), 1, file) == 1)
+          && (sum == checksum(a_image));
+    }
+
+    fclose(file);
+
+    if (!ok)
+        throw std::runtime_error("invalid checkpoint " + a_filename);
+}
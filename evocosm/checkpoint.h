@@ -0,0 +1,331 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_CHECKPOINT_H)
+#define LIBEVOCOSM_CHECKPOINT_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! Accumulates the binary image of a checkpoint
+    /*!
+        Values are appended in native byte order; a checkpoint is meant to
+        be restored on the machine (or at least the architecture) that
+        wrote it.
+    */
+    class checkpoint_writer
+    {
+    public:
+        //! Constructor
+        checkpoint_writer()
+          : m_data()
+        {
+            // nada
+        }
+
+        //! Append a plain value
+        /*!
+            \param a_value - A value of a trivially-copyable type
+        */
+        template <typename Type>
+        void put(const Type & a_value)
+        {
+            put_bytes(&a_value, sizeof(Type));
+        }
+
+        //! Append a size or count
+        /*!
+            Sizes are always stored as 64 bits.
+            \param a_size - The value to be stored
+        */
+        void put_size(size_t a_size)
+        {
+            put(static_cast<uint64_t>(a_size));
+        }
+
+        //! Append raw bytes
+        /*!
+            \param a_data - Start of the bytes
+            \param a_length - Number of bytes
+        */
+        void put_bytes(const void * a_data, size_t a_length)
+        {
+            const unsigned char * bytes = static_cast<const unsigned char *>(a_data);
+            m_data.insert(m_data.end(), bytes, bytes + a_length);
+        }
+
+        //! Get the image
+        vector<unsigned char> & data()
+        {
+            return m_data;
+        }
+
+    private:
+        // the image
+        vector<unsigned char> m_data;
+    };
+
+    //! Reads values back from the image of a checkpoint
+    /*!
+        Reading past the end of the image throws std::runtime_error.
+    */
+    class checkpoint_reader
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_data - The image; must outlive the reader
+        */
+        checkpoint_reader(const vector<unsigned char> & a_data)
+          : m_data(a_data),
+            m_pos(0)
+        {
+            // nada
+        }
+
+        //! Read a plain value
+        /*!
+            \return A value of a trivially-copyable type
+        */
+        template <typename Type>
+        Type get()
+        {
+            Type result;
+            get_bytes(&result, sizeof(Type));
+            return result;
+        }
+
+        //! Read a size or count
+        size_t get_size()
+        {
+            return static_cast<size_t>(get<uint64_t>());
+        }
+
+        //! Read raw bytes
+        /*!
+            \param a_data - Destination
+            \param a_length - Number of bytes
+        */
+        void get_bytes(void * a_data, size_t a_length)
+        {
+            if (a_length > m_data.size() - m_pos)
+                throw std::runtime_error("truncated checkpoint");
+
+            memcpy(a_data, &m_data[m_pos], a_length);
+            m_pos += a_length;
+        }
+
+        //! Has the whole image been read?
+        bool at_end() const
+        {
+            return m_pos == m_data.size();
+        }
+
+    private:
+        // the image
+        const vector<unsigned char> & m_data;
+
+        // read position
+        size_t m_pos;
+    };
+
+    //! Serialization trait
+    /*!
+        Writes and reads values of a type in a checkpoint. By default, a type
+        serializes itself: it must have a member function
+        <code>void save(checkpoint_writer &) const</code>, and a restoring
+        constructor that takes a <code>checkpoint_reader &</code>. Types that
+        can't be given members, such as Standard Library containers, have
+        specializations instead.
+        \param Type - The type to be serialized
+    */
+    template <typename Type>
+    struct serializer
+    {
+        //! Write a value
+        static void write(checkpoint_writer & a_out, const Type & a_value)
+        {
+            a_value.save(a_out);
+        }
+
+        //! Read a value
+        static Type read(checkpoint_reader & a_in)
+        {
+            return Type(a_in);
+        }
+    };
+
+    //! Serialization of floating-point genes
+    template <typename Allocator>
+    struct serializer< vector<double, Allocator> >
+    {
+        //! Write a vector
+        static void write(checkpoint_writer & a_out, const vector<double, Allocator> & a_value)
+        {
+            a_out.put_size(a_value.size());
+
+            if (!a_value.empty())
+                a_out.put_bytes(&a_value[0], sizeof(double) * a_value.size());
+        }
+
+        //! Read a vector
+        static vector<double, Allocator> read(checkpoint_reader & a_in)
+        {
+            vector<double, Allocator> result(a_in.get_size());
+
+            if (!result.empty())
+                a_in.get_bytes(&result[0], sizeof(double) * result.size());
+
+            return result;
+        }
+    };
+
+    //! Serialization of organisms
+    /*!
+        Stores an organism's fitness and genes. Organisms are rebuilt with
+        their value constructor, so any other data in a derived organism
+        class (e.g., function_solution::value) takes its default value, and
+        should be something the next fitness test recomputes.
+        \param OrganismType - The type of organism
+    */
+    template <typename OrganismType>
+    struct organism_serializer
+    {
+        //! Write an organism
+        static void write(checkpoint_writer & a_out, const OrganismType & a_organism)
+        {
+            a_out.put(a_organism.fitness);
+            serializer<decltype(a_organism.genes)>::write(a_out, a_organism.genes);
+        }
+
+        //! Read an organism
+        static OrganismType read(checkpoint_reader & a_in)
+        {
+            double fitness = a_in.get<double>();
+            OrganismType result(serializer<decltype(std::declval<OrganismType &>().genes)>::read(a_in));
+            result.fitness = fitness;
+            return result;
+        }
+    };
+
+    //! Writes checkpoint files atomically, in the background
+    /*!
+        The thread running evolution captures a checkpoint in memory (which
+        is quick), and hands the image to a checkpointer; a background thread
+        writes it to a temporary file, syncs it to disk, and renames it over
+        the previous checkpoint. A crash at any moment leaves either the old
+        checkpoint or the new one, never a partial file.
+        <p>
+        A file holds an 8-byte magic string ("EVOCKPT1"), a 32-bit format
+        version, 32 bits of flags, the ID of the random engine and the
+        number of words in the random state (both 32 bits), the image
+        length, the image itself, and a 64-bit FNV-1a checksum of the image.
+        A file is only read by a library built with the same version,
+        engine and random state size, since the image holds the state of
+        the generator.
+        <p>
+        Programs using this class must be compiled and linked with thread
+        support (e.g., <i>-pthread</i>).
+    */
+    class checkpointer
+    {
+    public:
+        //! Version number of the file format
+        /*!
+            Raised whenever the layout of an image changes, so load rejects
+            images written by older code instead of misreading them:
+            <ul>
+            <li>1: first version</li>
+            <li>2: analyzers derived from stagnation_analyzer (including
+                function_analyzer) save their state</li>
+            <li>3: the header names the random engine and its state size;
+                the generator's state includes its seed and stream</li>
+            <li>4: the generator's state includes the position in its
+                buffer of drawn values</li>
+            </ul>
+        */
+        static const uint32_t VERSION = 4;
+
+        //! Creation constructor
+        /*!
+            \param a_filename - Name of the checkpoint file
+        */
+        checkpointer(const std::string & a_filename);
+
+        //! Destructor
+        /*!
+            Waits for any write in progress.
+        */
+        ~checkpointer();
+
+        //! Write a checkpoint in the background
+        /*!
+            Waits for the previous write, if it is still in progress, then
+            starts writing the image. The image is taken over by the
+            checkpointer; the writer is left empty.
+            \param a_image - Image of the checkpoint
+        */
+        void save(checkpoint_writer & a_image);
+
+        //! Wait for the write in progress
+        /*!
+            \return <b>false</b> if the last write failed
+        */
+        bool wait();
+
+        //! Read a checkpoint file
+        /*!
+            Throws std::runtime_error if the file is missing, damaged, of a
+            different format version, or written with a different random
+            engine.
+            \param a_filename - Name of the checkpoint file
+            \param a_image - Receives the image of the checkpoint
+        */
+        static void load(const std::string & a_filename, vector<unsigned char> & a_image);
+
+    private:
+        // not copyable
+        checkpointer(const checkpointer &);
+        checkpointer & operator = (const checkpointer &);
+
+        // body of the writing thread
+        void write_file();
+
+        // name of the checkpoint file
+        std::string m_filename;
+
+        // image being written
+        vector<unsigned char> m_image;
+
+        // did the last write succeed?
+        bool m_ok;
+
+        // the writing thread
+        std::thread m_writer;
+    };
+};
+
+#endif
@@ -0,0 +1,396 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "evaluator_pool.h"
+using namespace libevocosm;
+
+// bytes in an answer
+static const size_t ANSWER_SIZE = sizeof(uint64_t) + sizeof(double);
+
+// constructor
+evaluator_pool::evaluator_pool(const vector<std::string> & a_command,
+                               size_t                      a_workers,
+                               double                      a_timeout,
+                               double                      a_failure_fitness,
+                               size_t                      a_depth)
+  : m_command(a_command),
+    m_workers(a_workers > 0 ? a_workers : 1),
+    m_timeout(a_timeout > 0.0 ? static_cast<uint64_t>(a_timeout * 1.0e9) : 0),
+    m_failure_fitness(a_failure_fitness),
+    m_depth(a_depth > 0 ? a_depth : 1),
+    m_restarts(0),
+    m_timeouts(0)
+{
+    if (m_command.empty())
+        throw std::runtime_error("evaluator_pool needs a command");
+
+    // a worker closes the sockets of the others, so none may look open before it starts
+    for (size_t n = 0; n < m_workers.size(); ++n)
+    {
+        m_workers[n].pid = -1;
+        m_workers[n].fd  = -1;
+    }
+
+    for (size_t n = 0; n < m_workers.size(); ++n)
+        start(m_workers[n]);
+}
+
+// destructor
+evaluator_pool::~evaluator_pool()
+{
+    // end of input tells a worker to quit
+    for (size_t n = 0; n < m_workers.size(); ++n)
+    {
+        if (m_workers[n].fd >= 0)
+            close(m_workers[n].fd);
+    }
+
+    for (size_t n = 0; n < m_workers.size(); ++n)
+    {
+        if (m_workers[n].pid > 0)
+            waitpid(m_workers[n].pid, NULL, 0);
+    }
+}
+
+// launch a worker
+void evaluator_pool::start(worker & a_worker)
+{
+    int fds[2];
+
+    // a socket, rather than pipes, so writes to a dead worker can't raise SIGPIPE
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        throw std::runtime_error("evaluator_pool: unable to create socket");
+
+    fflush(NULL);
+
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("evaluator_pool: unable to fork");
+    }
+
+    if (pid == 0)
+    {
+        dup2(fds[1], STDIN_FILENO);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+
+        // other workers' sockets must not stay open in this one
+        for (size_t n = 0; n < m_workers.size(); ++n)
+        {
+            if (m_workers[n].fd >= 0)
+                close(m_workers[n].fd);
+        }
+
+        vector<char *> args;
+
+        for (size_t n = 0; n < m_command.size(); ++n)
+            args.push_back(const_cast<char *>(m_command[n].c_str()));
+
+        args.push_back(NULL);
+
+        execvp(args[0], &args[0]);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    a_worker.pid = pid;
+    a_worker.fd  = fds[0];
+    a_worker.in_flight.clear();
+    a_worker.output.clear();
+    a_worker.output_pos = 0;
+    a_worker.input.clear();
+    a_worker.started = 0;
+}
+
+// end a worker
+void evaluator_pool::stop(worker & a_worker)
+{
+    if (a_worker.fd >= 0)
+        close(a_worker.fd);
+
+    if (a_worker.pid > 0)
+    {
+        kill(a_worker.pid, SIGKILL);
+        waitpid(a_worker.pid, NULL, 0);
+    }
+
+    a_worker.pid = -1;
+    a_worker.fd  = -1;
+}
+
+// frame a request
+void evaluator_pool::send(worker & a_worker, size_t a_index, const vector<unsigned char> & a_genome)
+{
+    uint64_t header[2] = { static_cast<uint64_t>(a_index), static_cast<uint64_t>(a_genome.size()) };
+    const unsigned char * bytes = reinterpret_cast<const unsigned char *>(header);
+
+    a_worker.output.insert(a_worker.output.end(), bytes, bytes + sizeof(header));
+    a_worker.output.insert(a_worker.output.end(), a_genome.begin(), a_genome.end());
+
+    if (a_worker.in_flight.empty())
+        a_worker.started = metrics_recorder::now();
+
+    a_worker.in_flight.push_back(a_index);
+}
+
+// evaluate a batch
+size_t evaluator_pool::evaluate(const vector< vector<unsigned char> > & a_genomes, vector<double> & a_fitness)
+{
+    a_fitness.assign(a_genomes.size(), m_failure_fitness);
+
+    std::deque<size_t> pending;
+
+    for (size_t n = 0; n < a_genomes.size(); ++n)
+        pending.push_back(n);
+
+    size_t remaining = a_genomes.size();
+    size_t failures = 0;
+    size_t fruitless = 0;
+    vector<pollfd> polls(m_workers.size());
+
+    while (remaining > 0)
+    {
+        // keep every worker supplied
+        for (size_t w = 0; w < m_workers.size(); ++w)
+        {
+            while (!pending.empty() && (m_workers[w].in_flight.size() < m_depth))
+            {
+                send(m_workers[w], pending.front(), a_genomes[pending.front()]);
+                pending.pop_front();
+            }
+        }
+
+        // wait until something happens, or the nearest deadline
+        uint64_t now = metrics_recorder::now();
+        int wait_ms = -1;
+
+        for (size_t w = 0; w < m_workers.size(); ++w)
+        {
+            worker & wk = m_workers[w];
+
+            polls[w].fd      = wk.fd;
+            polls[w].events  = POLLIN | ((wk.output_pos < wk.output.size()) ? POLLOUT : 0);
+            polls[w].revents = 0;
+
+            if ((m_timeout > 0) && !wk.in_flight.empty())
+            {
+                uint64_t deadline = wk.started + m_timeout;
+                int ms = (deadline > now) ? static_cast<int>((deadline - now) / 1000000 + 1) : 0;
+
+                if ((wait_ms < 0) || (ms < wait_ms))
+                    wait_ms = ms;
+            }
+        }
+
+        if (poll(&polls[0], polls.size(), wait_ms) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            throw std::runtime_error("evaluator_pool: poll failed");
+        }
+
+        now = metrics_recorder::now();
+
+        for (size_t w = 0; w < m_workers.size(); ++w)
+        {
+            worker & wk = m_workers[w];
+            bool failed = false;
+
+            if (polls[w].revents & POLLOUT)
+            {
+                ssize_t count = ::send(wk.fd, &wk.output[wk.output_pos], wk.output.size() - wk.output_pos, MSG_NOSIGNAL);
+
+                if (count > 0)
+                {
+                    wk.output_pos += static_cast<size_t>(count);
+
+                    if (wk.output_pos == wk.output.size())
+                    {
+                        wk.output.clear();
+                        wk.output_pos = 0;
+                    }
+                }
+                else if ((count < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+                    failed = true;
+            }
+
+            if (!failed && (polls[w].revents & (POLLIN | POLLHUP | POLLERR)))
+            {
+                unsigned char buffer[4096];
+                ssize_t count = recv(wk.fd, buffer, sizeof(buffer), 0);
+
+                if (count > 0)
+                {
+                    wk.input.insert(wk.input.end(), buffer, buffer + count);
+
+                    size_t pos = 0;
+
+                    while (!failed && (wk.input.size() - pos >= ANSWER_SIZE))
+                    {
+                        uint64_t id;
+                        double fitness;
+                        memcpy(&id, &wk.input[pos], sizeof(id));
+                        memcpy(&fitness, &wk.input[pos + sizeof(id)], sizeof(fitness));
+                        pos += ANSWER_SIZE;
+
+                        // answers out of order mean the worker is confused
+                        if (wk.in_flight.empty() || (wk.in_flight.front() != id))
+                        {
+                            failed = true;
+                            break;
+                        }
+
+#if defined(EVOCOSM_METRICS)
+                        metrics_recorder::record_evaluation(now - wk.started);
+#endif
+
+                        a_fitness[static_cast<size_t>(id)] = fitness;
+                        wk.in_flight.pop_front();
+                        wk.started = now;
+                        --remaining;
+                        fruitless = 0;
+                    }
+
+                    wk.input.erase(wk.input.begin(), wk.input.begin() + pos);
+                }
+                else if ((count == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)))
+                    failed = true;
+            }
+
+            if (!failed && (m_timeout > 0) && !wk.in_flight.empty() && (now - wk.started > m_timeout))
+            {
+                failed = true;
+                ++m_timeouts;
+            }
+
+            if (failed)
+            {
+                // the current request is charged; the rest go to other workers
+                if (!wk.in_flight.empty())
+                {
+                    wk.in_flight.pop_front();
+                    ++failures;
+                    --remaining;
+                }
+
+                while (!wk.in_flight.empty())
+                {
+                    pending.push_front(wk.in_flight.back());
+                    wk.in_flight.pop_back();
+                }
+
+                if (++fruitless > 3 * m_workers.size())
+                    throw std::runtime_error("evaluator_pool: workers keep failing; check the command " + m_command[0]);
+
+                stop(wk);
+                start(wk);
+                ++m_restarts;
+            }
+        }
+    }
+
+    return failures;
+}
+
+// read exactly a number of bytes
+static bool read_all(int a_fd, void * a_data, size_t a_length)
+{
+    unsigned char * data = static_cast<unsigned char *>(a_data);
+    size_t done = 0;
+
+    while (done < a_length)
+    {
+        ssize_t count = read(a_fd, data + done, a_length - done);
+
+        if ((count < 0) && (errno == EINTR))
+            continue;
+
+        if (count <= 0)
+            return false;
+
+        done += static_cast<size_t>(count);
+    }
+
+    return true;
+}
+
+// write exactly a number of bytes
+static bool write_all(int a_fd, const void * a_data, size_t a_length)
+{
+    const unsigned char * data = static_cast<const unsigned char *>(a_data);
+    size_t done = 0;
+
+    while (done < a_length)
+    {
+        ssize_t count = write(a_fd, data + done, a_length - done);
+
+        if ((count < 0) && (errno == EINTR))
+            continue;
+
+        if (count <= 0)
+            return false;
+
+        done += static_cast<size_t>(count);
+    }
+
+    return true;
+}
+
+// worker side
+int evaluator_pool::serve(t_evaluation * a_function)
+{
+    uint64_t header[2];
+    vector<unsigned char> genome;
+
+    while (read_all(STDIN_FILENO, header, sizeof(header)))
+    {
+        genome.resize(static_cast<size_t>(header[1]));
+
+        if (!genome.empty() && !read_all(STDIN_FILENO, &genome[0], genome.size()))
+            return 1;
+
+        checkpoint_reader reader(genome);
+        double fitness = a_function(reader);
+
+        unsigned char answer[ANSWER_SIZE];
+        memcpy(answer, &header[0], sizeof(uint64_t));
+        memcpy(answer + sizeof(uint64_t), &fitness, sizeof(double));
+
+        if (!write_all(STDOUT_FILENO, answer, sizeof(answer)))
+            return 1;
+    }
+
+    return 0;
+}
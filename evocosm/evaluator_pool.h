@@ -0,0 +1,246 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_EVALUATOR_POOL_H)
+#define LIBEVOCOSM_EVALUATOR_POOL_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// POSIX
+#include <sys/types.h>
+
+// libevocosm
+#include "listener.h"
+#include "landscape.h"
+#include "checkpoint.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! A pool of long-lived processes that compute fitness
+    /*!
+        When fitness comes from an external simulator, starting a process
+        for every test costs more than the test. An evaluator_pool starts a
+        fixed number of worker processes once, and streams requests to them.
+        <p>
+        A worker reads requests from standard input and writes answers to
+        standard output, in native byte order:
+        <pre>
+            request: uint64 id, uint64 length, length bytes of genome
+            answer:  uint64 id, double fitness
+        </pre>
+        Answers must come back in the order requests were sent. Each worker
+        is given up to <i>depth</i> requests at a time, so it never waits
+        for the next one. A program can act as a worker by calling serve.
+        <p>
+        A worker that exits, or takes longer than the timeout to answer a
+        request, is killed and restarted. The request it was working on is
+        charged with the failure fitness; the others it held are sent to
+        another worker. If workers keep dying without answering anything
+        (for instance, because the command doesn't exist), evaluate throws
+        std::runtime_error.
+        <p>
+        Requires POSIX <i>fork</i>, <i>exec</i>, and <i>poll</i>.
+    */
+    class evaluator_pool
+    {
+    public:
+        //! Type of function used by serve
+        /*!
+            Computes fitness from a genome, as serialized by the requester.
+        */
+        typedef double t_evaluation(checkpoint_reader & a_genome);
+
+        //! Creation constructor
+        /*!
+            Starts the workers.
+            \param a_command - Program and arguments for a worker, passed to <i>execvp</i>
+            \param a_workers - Number of worker processes
+            \param a_timeout - Longest a worker may take on one request, in seconds; zero means no limit
+            \param a_failure_fitness - Fitness given to a request whose worker crashed or timed out
+            \param a_depth - Requests outstanding at each worker
+        */
+        evaluator_pool(const vector<std::string> & a_command,
+                       size_t                      a_workers,
+                       double                      a_timeout = 0.0,
+                       double                      a_failure_fitness = 0.0,
+                       size_t                      a_depth = 4);
+
+        //! Destructor
+        /*!
+            Closes the workers' input, which tells them to exit, and waits
+            for them.
+        */
+        ~evaluator_pool();
+
+        //! Compute fitness for a batch of genomes
+        /*!
+            \param a_genomes - Serialized genomes
+            \param a_fitness - Receives a fitness for each genome
+            \return Number of genomes charged with the failure fitness
+        */
+        size_t evaluate(const vector< vector<unsigned char> > & a_genomes, vector<double> & a_fitness);
+
+        //! Get the number of workers
+        size_t get_workers() const
+        {
+            return m_workers.size();
+        }
+
+        //! Get the number of times a worker was restarted
+        size_t get_restarts() const
+        {
+            return m_restarts;
+        }
+
+        //! Get the number of requests that timed out
+        size_t get_timeouts() const
+        {
+            return m_timeouts;
+        }
+
+        //! Act as a worker
+        /*!
+            Answers requests from standard input until it is closed. Answers
+            go to standard output, so the function must not write there.
+            \param a_function - Computes fitness
+            \return Exit status for the worker program
+        */
+        static int serve(t_evaluation * a_function);
+
+    private:
+        // not copyable
+        evaluator_pool(const evaluator_pool &);
+        evaluator_pool & operator = (const evaluator_pool &);
+
+        // a worker process
+        struct worker
+        {
+            pid_t pid;                      // process
+            int fd;                         // socket connected to its standard input and output
+            std::deque<size_t> in_flight;   // requests sent, in order
+            vector<unsigned char> output;   // bytes waiting to be sent
+            size_t output_pos;              // bytes of output already sent
+            vector<unsigned char> input;    // partial answer
+            uint64_t started;               // when the oldest request became its current work, in ns
+        };
+
+        // start a worker
+        void start(worker & a_worker);
+
+        // kill a worker
+        void stop(worker & a_worker);
+
+        // queue a request for a worker
+        void send(worker & a_worker, size_t a_index, const vector<unsigned char> & a_genome);
+
+        // program and arguments
+        vector<std::string> m_command;
+
+        // the workers
+        vector<worker> m_workers;
+
+        // time limit in ns
+        uint64_t m_timeout;
+
+        // fitness of failed requests
+        double m_failure_fitness;
+
+        // requests per worker
+        size_t m_depth;
+
+        // statistics
+        size_t m_restarts;
+        size_t m_timeouts;
+    };
+
+    //! A landscape that tests organisms in an evaluator_pool
+    /*!
+        Serializes each organism's genes (see serializer in checkpoint.h)
+        and sends the whole population to the pool at once. The rest of the
+        engine sees an ordinary landscape.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class pool_landscape : public landscape<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_listener - A listener for events
+            \param a_pool - Computes fitness; must outlive the landscape
+        */
+        pool_landscape(listener<OrganismType> & a_listener, evaluator_pool & a_pool)
+          : landscape<OrganismType>(a_listener),
+            m_pool(a_pool)
+        {
+            // nada
+        }
+
+        //! Performs fitness testing
+        /*!
+            Tests a single organism; testing a population at once is much
+            faster.
+            \param a_organism - The organism to be tested
+            \param a_verbose - Ignored
+            \return Computed fitness for this organism
+        */
+        virtual double test(OrganismType & a_organism, bool a_verbose = false) const
+        {
+            vector<OrganismType> single(1, a_organism);
+            test(single);
+            a_organism.fitness = single[0].fitness;
+            return a_organism.fitness;
+        }
+
+        //! Performs fitness testing
+        /*!
+            Tests every organism, spread across the pool's workers.
+            \param a_population - Organisms to be tested
+            \return Zero, as for the base class
+        */
+        virtual double test(vector<OrganismType> & a_population) const
+        {
+            vector< vector<unsigned char> > genomes(a_population.size());
+
+            for (size_t n = 0; n < a_population.size(); ++n)
+            {
+                checkpoint_writer image;
+                serializer<decltype(a_population[n].genes)>::write(image, a_population[n].genes);
+                genomes[n].swap(image.data());
+            }
+
+            vector<double> fitness;
+            m_pool.evaluate(genomes, fitness);
+
+            for (size_t n = 0; n < a_population.size(); ++n)
+                a_population[n].fitness = fitness[n];
+
+            return 0.0;
+        }
+
+    private:
+        // the workers
+        evaluator_pool & m_pool;
+    };
+};
+
+#endif
@@ -13,10 +13,26 @@
     You license Evocosm under the Simplified BSD License (FreeBSD License).
 */
 
+#include <atomic>
+#include <chrono>
+
 #include "evocommon.h"
 
-// a global random number generator for all Evocosm classes
-libevocosm::prng libevocosm::globals::g_random;
+// a global random number generator for all Evocosm classes; each thread's is seeded differently
+thread_local libevocosm::prng libevocosm::globals::g_random(libevocosm::globals::thread_seed());
+
+// seed for a new thread's generator
+unsigned long long int libevocosm::globals::thread_seed()
+{
+    static std::atomic<unsigned long long int> s_count(0);
+
+    unsigned long long int count = s_count.fetch_add(1, std::memory_order_relaxed);
+    unsigned long long int state = static_cast<unsigned long long int>(std::chrono::system_clock::now().time_since_epoch().count());
+
+    // splitmix64 is a bijection, so calls that read the same clock still get distinct seeds
+    state = splitmix64(state) + count * 0x9E3779B97F4A7C15ULL;
+    return splitmix64(state);
+}
 
 #if defined(_MSC_VER)
 std::string libevocosm::globals::g_version("4.0.0");
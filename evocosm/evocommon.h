@@ -17,66 +17,29 @@
 #define LIBEVOCOSM_EVOCOMMON_H
 
 // Standard C++ Library
+#include <cstddef>
 #include <string>
 #include <ctime>
 
+// libevocosm
+#include "prng.h"
+
 namespace libevocosm
 {
-    //! The random number generator used by Evocosm
+#if !defined(EVOCOSM_PRNG_ENGINE)
+    //! The engine behind Evocosm's random numbers
     /*!
-        The 64-bit "Keep It Simple Stupid" psuedorandom number generator
-        by Marsaglia in the following thread:
-            http://www.thecodingforums.com/threads/64-bit-kiss-rngs.673657/
+        One of kiss_engine, xoshiro256_engine, pcg64_engine, or
+        philox_engine (see prng.h), or any class with the same members.
+        Chosen with configure's --with-prng option; like EVOCOSM_METRICS,
+        it must be defined the same way for the library and for every
+        program that uses it.
     */
-    class prng
-    {
-    private:
-        unsigned long long int x = 1234567890987654321ULL;
-        unsigned long long int c =  123456123456123456ULL;
-        unsigned long long int y =  362436362436362436ULL;
-        unsigned long long int z =    1066149217761810ULL;
-        unsigned long long int t =   29979245822353888ULL;
-        unsigned long long int s =   t;
-
-    public:
-        //! Constructor
-        prng(const unsigned long long seed = (unsigned long long int)(time(nullptr)))
-        {
-            set_seed(seed);
-        }
-        
-        void set_seed(unsigned long long int seed = (unsigned long long int)(time(nullptr)))
-        {
-            s = seed;
-            t = s;
-        }
-        
-        unsigned long long int get_seed()
-        {
-            return s;
-        }
-        
-        unsigned long long int next()
-        {
-            t = (t = (x << 58) + c, c = (x >> 6), x += t, c += (x < t), x)
-              + (y ^= (y << 13), y ^= (y >> 17), y ^= (y << 43))
-              + (z = 6906969069LL * z + 1234567);
-            
-            return t;
-        }
-
-        //! get a random index value
-        size_t get_index(size_t n)
-        {
-            return next() % n;
-        }
+    #define EVOCOSM_PRNG_ENGINE xoshiro256_engine
+#endif
 
-        //! get the next value in the range [0,1)
-        double get_real()
-        {
-            return (double)((double)next() / 18446744073709551615.0);
-        }
-    };
+    //! The random number generator used by Evocosm
+    typedef basic_prng<EVOCOSM_PRNG_ENGINE> prng;
 
     //! Elements shared by all classes in Evocosm
     /*!
@@ -92,14 +55,31 @@ namespace libevocosm
             return g_random.get_index(n);
         }
 
-        //! A shared random number generator
-        static prng g_random;
+        //! The random number generator
+        /*!
+            Each thread has its own generator, so threads (such as the
+            islands of an archipelago) draw independent sequences without
+            locking. A new thread's generator is seeded by thread_seed, so
+            threads started together draw different sequences.
+        */
+        static thread_local prng g_random;
+
+        //! Get a seed for a new thread's generator
+        /*!
+            Mixes the clock with a count of the seeds handed out, so calls
+            made at the same moment still give different seeds.
+            \return A seed for a thread's generator
+        */
+        static unsigned long long int thread_seed();
 
         //! Version number
         static std::string g_version;
 
     public:
         //! Set the seed for the random number generator
+        /*!
+            Affects only the generator of the calling thread.
+        */
         static void set_seed(const unsigned long long int a_seed)
         {
             g_random.set_seed(a_seed);
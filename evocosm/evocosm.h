@@ -26,7 +26,8 @@
 
 // Standard C++ library
 #include <vector>
-#include <unistd.h>
+#include <chrono>
+#include <thread>
 
 // libevocosm
 #include "validator.h"
@@ -38,6 +39,8 @@
 #include "scaler.h"
 #include "selector.h"
 #include "analyzer.h"
+#include "scheduler.h"
+#include "checkpoint.h"
 
 //! A toolkit and framework for implementing evolutionary algorithms.
 /*!
@@ -53,6 +56,34 @@ namespace libevocosm
 {
     using std::vector;
 
+    //! Works on a population between fitness testing and selection
+    /*!
+        An evocosm calls its hook, if it has one, after each fitness test
+        and before the results are reported, analyzed, or selected from,
+        so the hook sees fitness values that belong to the organisms.
+        Archipelagos use this to migrate organisms between islands.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class test_hook
+    {
+    public:
+        //! Virtual destructor
+        virtual ~test_hook()
+        {
+            // nada
+        }
+
+        //! Called when a population has been tested
+        /*!
+            The hook may change the population, as long as every organism
+            it leaves there has a valid fitness.
+            \param a_population - The tested population
+            \param a_iteration - The generation being run
+        */
+        virtual void tested(vector<OrganismType> & a_population, size_t a_iteration) = 0;
+    };
+
     //! Associates organisms with the components of an evolutionary system.
     /*!
         This is where it all comes together: An evocosm binds a
@@ -94,6 +125,20 @@ namespace libevocosm
         //! Number microseconds for process to sleep on yield
         unsigned int m_sleep_time;
 
+        //! Default scheduler, used until another is set
+        null_scheduler m_null_scheduler;
+
+        //! Decides what happens when the evocosm yields
+        scheduler * m_scheduler;
+
+        //! Called after each fitness test, if not NULL
+        test_hook<OrganismType> * m_test_hook;
+
+#if defined(EVOCOSM_METRICS)
+        //! Times the phases of each generation
+        metrics_recorder m_metrics;
+#endif
+
     public:
         //! Creation constructor
         /*!
@@ -153,6 +198,14 @@ namespace libevocosm
             replaced by in a derived class to define a different processing
             sequence; the default sequence defined here is good for most
             evolutionary algorithms I've created.
+            <p>
+            The test hook, if one is set, is called right after fitness
+            testing.
+            <p>
+            If the scheduler stops evolution, this function returns <i>false</i>
+            at once, without announcing run_complete or reporting metrics for
+            the partial generation; the population is only replaced if the
+            generation got that far.
             \return Returns <i>true</i> when the generation has reached a specific goal.
         */
         virtual bool run_generation();
@@ -168,6 +221,48 @@ namespace libevocosm
             return m_population;
         }
 
+        //! Get the scheduler
+        /*!
+            \return The scheduler invoked when this evocosm yields
+        */
+        scheduler & get_scheduler()
+        {
+            return *m_scheduler;
+        }
+
+        //! Set the scheduler
+        /*!
+            Sets the object that decides what happens at each yield. The
+            scheduler must continue to exist during the lifetime of the
+            evocosm, or until it is replaced.
+            \param a_scheduler - The new scheduler
+        */
+        void set_scheduler(scheduler & a_scheduler)
+        {
+            m_scheduler = &a_scheduler;
+        }
+
+        //! Get the test hook
+        /*!
+            \return The hook called after each fitness test, or NULL
+        */
+        test_hook<OrganismType> * get_test_hook()
+        {
+            return m_test_hook;
+        }
+
+        //! Set the test hook
+        /*!
+            Sets an object to be called after each fitness test. The hook
+            must continue to exist during the lifetime of the evocosm, or
+            until it is replaced.
+            \param a_hook - The new hook, or NULL for none
+        */
+        void set_test_hook(test_hook<OrganismType> * a_hook)
+        {
+            m_test_hook = a_hook;
+        }
+
         //! Get the sleep time property value
         /*!
             Get the sleep time setting for this listerner.
@@ -180,7 +275,9 @@ namespace libevocosm
 
         //! Set the sleep time property value
         /*!
-            Set the sleep time property value.
+            Set the sleep time property value. The sleep time defaults to zero;
+            this remains for compatibility, but a control_scheduler offers
+            throttling that can be changed while evolution runs.
             /param a_sleep_time new value of sleep time (microseconds)
         */
         void set_sleep_time(unsigned int a_sleep_time)
@@ -188,23 +285,70 @@ namespace libevocosm
             m_sleep_time = a_sleep_time;
         }
 
+        //! Get the number of generations run
+        size_t get_iteration() const
+        {
+            return m_iteration;
+        }
+
+        //! Capture the state of evolution
+        /*!
+            Writes the generation count, the state of the shared random number
+            generator, the population, and the analyzer's state. Call this
+            between generations, then hand the image to a checkpointer to be
+            written in the background. Organism genes are written with the
+            serializer trait for their type.
+            \param a_out - Checkpoint being written
+        */
+        void save_checkpoint(checkpoint_writer & a_out) const;
+
+        //! Resume from a captured state
+        /*!
+            Replaces the population, generation count, random number generator
+            state, and analyzer state with those from a checkpoint. Evolution
+            then continues exactly as it would have from the point where the
+            checkpoint was taken, given the same components.
+            \param a_in - Checkpoint being read
+        */
+        void restore_checkpoint(checkpoint_reader & a_in);
+
     protected:
         //! Yield
         /*!
-            Evocosm periodically invokes this function to allow other processes
-            to run. In most cases, this will be some sort of platform-specific
-            sleep function, such as usleep.
+            Evocosm invokes this function between the phases of a generation,
+            to let the scheduler pause, throttle, or stop evolution.
+            \return <b>false</b> if evolution should stop
         */
-        void yield()
+        bool yield()
         {
             if (m_sleep_time > 0)
-            {
-              #if defined(_MSC_VER)
-                Sleep(m_sleep_time);
-              #else
-                usleep((useconds_t)m_sleep_time);
-              #endif
-            }
+                std::this_thread::sleep_for(std::chrono::microseconds(m_sleep_time));
+
+            return m_scheduler->yield();
+        }
+
+        //! Mark the start of a generation phase
+        /*!
+            Does nothing unless EVOCOSM_METRICS is defined.
+            \param a_phase - The phase beginning
+        */
+        void begin_phase(generation_phase a_phase)
+        {
+#if defined(EVOCOSM_METRICS)
+            m_metrics.begin_phase(a_phase);
+#endif
+        }
+
+        //! Mark the end of a generation phase
+        /*!
+            Does nothing unless EVOCOSM_METRICS is defined.
+            \param a_phase - The phase ending
+        */
+        void end_phase(generation_phase a_phase)
+        {
+#if defined(EVOCOSM_METRICS)
+            m_metrics.end_phase(a_phase);
+#endif
         }
 
     };
@@ -228,7 +372,10 @@ namespace libevocosm
         m_analyzer(a_analyzer),
         m_listener(a_listener),
         m_iteration(0),
-        m_sleep_time(10000) // default to 10ms sleep time
+        m_sleep_time(0),
+        m_null_scheduler(),
+        m_scheduler(&m_null_scheduler),
+        m_test_hook(NULL)
     {
         // nada
     }
@@ -236,7 +383,7 @@ namespace libevocosm
     // copy constructor
     template <class OrganismType>
     evocosm<OrganismType>::evocosm(const evocosm<OrganismType> & a_source)
-      : m_population(a_source.a_population),
+      : m_population(a_source.m_population),
         m_landscape(a_source.m_landscape),
         m_mutator(a_source.m_mutator),
         m_reproducer(a_source.m_reproducer),
@@ -245,7 +392,10 @@ namespace libevocosm
         m_analyzer(a_source.m_analyzer),
         m_listener(a_source.m_listener),
         m_iteration(a_source.m_iteration),
-        m_sleep_time(a_source.m_sleep_time)
+        m_sleep_time(a_source.m_sleep_time),
+        m_null_scheduler(),
+        m_scheduler(a_source.m_scheduler == &a_source.m_null_scheduler ? &m_null_scheduler : a_source.m_scheduler),
+        m_test_hook(a_source.m_test_hook)
     {
         // nada
     }
@@ -268,10 +418,52 @@ namespace libevocosm
         m_listener    = a_source.m_analyzer;
         m_iteration   = a_source.m_iteration;
         m_sleep_time  = a_source.m_sleep_time;
+        m_scheduler   = (a_source.m_scheduler == &a_source.m_null_scheduler) ? &m_null_scheduler : a_source.m_scheduler;
+        m_test_hook   = a_source.m_test_hook;
 
         return *this;
     }
 
+    // capture state
+    template <class OrganismType>
+    void evocosm<OrganismType>::save_checkpoint(checkpoint_writer & a_out) const
+    {
+        unsigned long long int random_state[prng::STATE_WORDS];
+        g_random.get_state(random_state);
+
+        a_out.put_size(m_iteration);
+        a_out.put_bytes(random_state, sizeof(random_state));
+        a_out.put_size(m_population.size());
+
+        for (size_t n = 0; n < m_population.size(); ++n)
+            organism_serializer<OrganismType>::write(a_out, m_population[n]);
+
+        m_analyzer.save_state(a_out);
+    }
+
+    // resume from captured state
+    template <class OrganismType>
+    void evocosm<OrganismType>::restore_checkpoint(checkpoint_reader & a_in)
+    {
+        size_t iteration = a_in.get_size();
+
+        unsigned long long int random_state[prng::STATE_WORDS];
+        a_in.get_bytes(random_state, sizeof(random_state));
+
+        // build the population aside, so a bad checkpoint can't leave it half-restored
+        size_t count = a_in.get_size();
+        vector<OrganismType> population;
+
+        for (size_t n = 0; n < count; ++n)
+            population.push_back(organism_serializer<OrganismType>::read(a_in));
+
+        m_analyzer.restore_state(a_in);
+
+        m_iteration = iteration;
+        m_population.swap(population);
+        g_random.set_state(random_state);
+    }
+
     // compute next generation
     template <class OrganismType>
     bool evocosm<OrganismType>::run_generation()
@@ -280,52 +472,107 @@ namespace libevocosm
 
         ++m_iteration;
 
+#if defined(EVOCOSM_METRICS)
+        // stops recording however the generation ends
+        generation_recording recording(m_metrics, m_iteration);
+#endif
+
         // announce beginning of new generation
         m_listener.ping_generation_begin(m_population, m_iteration);
 
         // check population fitness
+        begin_phase(PHASE_TEST);
         m_landscape.test(m_population);
-        yield();
+        end_phase(PHASE_TEST);
+
+#if defined(EVOCOSM_METRICS)
+        // landscapes that test a population their own way don't report each evaluation
+        if (m_metrics.metrics().evaluations == 0)
+            m_metrics.metrics().evaluations = m_population.size();
+#endif
+
+        // fitness is current here, and nothing has been chosen by it yet
+        if (m_test_hook != NULL)
+            m_test_hook->tested(m_population, m_iteration);
+
+        if (!yield())
+            return false;
 
         // we're done testing this generation
+        begin_phase(PHASE_GENERATION_END);
         m_listener.ping_generation_end(m_population, m_iteration);
-        yield();
+        end_phase(PHASE_GENERATION_END);
+
+        if (!yield())
+            return false;
 
         // analyze the results of testing, and decide if we're going to stop or not
+        begin_phase(PHASE_ANALYZE);
         keep_going = m_analyzer.analyze(m_population, m_iteration);
+        end_phase(PHASE_ANALYZE);
 
         if (keep_going)
         {
             // fitness scaling
+            begin_phase(PHASE_SCALE);
             m_scaler.scale_fitness(m_population);
-            yield();
+            end_phase(PHASE_SCALE);
+
+            if (!yield())
+                return false;
 
             // get survivors and number of chromosomes to add
+            begin_phase(PHASE_SELECT);
             vector<OrganismType> survivors = m_selector.select_survivors(m_population);
-            yield();
+            end_phase(PHASE_SELECT);
 
-            // give birth to new chromosomes
+            if (!yield())
+                return false;
+
+            // give birth to new chromosomes; breeding and mutation draw from streams keyed
+            // by generation, so they don't depend on what came before them
+            begin_phase(PHASE_BREED);
+            g_random.set_stream(m_iteration, 0, STREAM_BREED);
             vector<OrganismType> children = m_reproducer.breed(m_population, m_population.size() - survivors.size());
-            yield();
+            end_phase(PHASE_BREED);
+
+#if defined(EVOCOSM_METRICS)
+            metrics_recorder::count_children(children.size());
+#endif
+
+            if (!yield())
+                return false;
 
             // debugging only
             //fitness_stats<OrganismType> s(survivors);
             //fitness_stats<OrganismType> c(children);
 
             // mutate the child chromosomes
+            begin_phase(PHASE_MUTATE);
+            g_random.set_stream(m_iteration, 0, STREAM_MUTATE);
             m_mutator.mutate(children);
-            yield();
+            end_phase(PHASE_MUTATE);
+
+            if (!yield())
+                return false;
 
             // append children to survivors and replace existing population form combined vector
+            begin_phase(PHASE_TURNOVER);
             survivors.insert(survivors.end(),children.begin(),children.end());
             m_population = survivors;
-            yield();
+            end_phase(PHASE_TURNOVER);
+
+            keep_going = yield();
         }
         else
         {
             m_listener.run_complete(m_population);
         }
 
+#if defined(EVOCOSM_METRICS)
+        m_listener.ping_generation_metrics(recording.finish());
+#endif
+
         return keep_going;
     }
 };
@@ -27,12 +27,23 @@ libevocosm::evoreal fopt_global::g_evoreal;
 // mutate a set of organisms
 void function_mutator::mutate(vector<function_solution> & a_population)
 {
+    // one thread-local lookup, rather than one per gene
+    prng & random = g_random;
+
     for (size_t i = 0; i < a_population.size(); ++i)
     {
+        random.set_organism(i);
+
         for (size_t n = 0; n < a_population[i].genes.size(); ++n)
         {
-            if (g_random.get_real() <= m_mutation_rate)
+            if (random.get_real() <= m_mutation_rate)
+            {
                 a_population[i].genes[n] = g_evoreal.mutate(a_population[i].genes[n]);
+
+#if defined(EVOCOSM_METRICS)
+                metrics_recorder::count_mutation();
+#endif
+            }
         }
 
     }
@@ -41,33 +52,32 @@ void function_mutator::mutate(vector<function_solution> & a_population)
 // create children
 vector<function_solution> function_reproducer::breed(const vector<function_solution> & a_population, size_t a_limit)
 {
-    // construct a fitness wheel
-    vector<double> wheel_weights;
+    // prepare to pick parents
+    parent_sampler<function_solution> & sampler = (m_sampler != NULL) ? *m_sampler : m_roulette;
+    sampler.prepare(a_population);
 
-    for (size_t i = 0; i < a_population.size(); ++i)
-        wheel_weights.push_back(a_population[i].fitness > 0.0 ? a_population[i].fitness : 0.0);
+    // create children; each is bred from a stream keyed to its index
+    vector<function_solution> children(a_limit);
 
-    roulette_wheel fitness_wheel(wheel_weights);
-
-    // create children
-    vector<function_solution> children;
-
-    while (a_limit > 0)
+    auto breed_child = [&] (size_t a_index)
     {
+        prng & random = g_random;
+        random.set_organism(a_index);
+
         // clone an existing organism as a child
-        size_t g1 = fitness_wheel.get_index();
-        vector<double> parent1 = a_population[g1].genes;
+        size_t g1 = sampler.pick(a_population);
+        pool_vector<double> parent1 = a_population[g1].genes;
 
         // do we crossover?
-        if (g_random.get_real() < m_crossover_rate)
+        if (random.get_real() < m_crossover_rate)
         {
             // select a second parent
             size_t g2 = g1;
 
             while (g2 == g1)
-                g2 = fitness_wheel.get_index();
+                g2 = sampler.pick(a_population);
 
-            const vector<double> parent2 = a_population[g2].genes;
+            const pool_vector<double> & parent2 = a_population[g2].genes;
 
             // reproduce
             for (size_t n = 0; n < parent1.size(); ++n)
@@ -75,10 +85,15 @@ vector<function_solution> function_reproducer::breed(const vector<function_solut
         }
 
         // add child to new population
-        children.push_back(function_solution(parent1));
+        children[a_index].genes.swap(parent1);
+    };
 
-        // one down, more to go?
-        --a_limit;
+    if (m_pool != NULL)
+        m_pool->parallel_for(a_limit, breed_child);
+    else
+    {
+        for (size_t i = 0; i < a_limit; ++i)
+            breed_child(i);
     }
 
     // outa here!
@@ -90,32 +105,7 @@ bool function_analyzer::analyze(const vector<function_solution> & a_population,
                                 size_t a_iteration,
                                 double & a_fitness)
 {
-    fitness_stats<function_solution> stats(a_population);
-
-    // see if the current best equals the previous best
-    if (m_prev_best.genes.size() == stats.getBest().genes.size())
-    {
-        bool equal = true;
-
-        for (size_t n = 0; n < m_prev_best.genes.size(); ++n)
-        {
-            if (m_prev_best.genes[n] != stats.getBest().genes[n])
-            {
-                equal = false;
-                break;
-            }
-        }
-
-        if (equal)
-            ++m_count;
-        else
-            m_count = 0;
-    }
-
-    m_prev_best = stats.getBest();
-
-    // if the best is the same ten generations in a row, we're done (in theory)
-    return ((m_count < 20) || (m_max_iterations == a_iteration));
+    return stagnation_analyzer<function_solution>::analyze(a_population, a_iteration);
 }
 
 void function_listener::ping_generation_begin(size_t a_iteration)
@@ -139,7 +129,7 @@ void function_listener::ping_generation_end(const vector<function_solution> & a_
     for (size_t n = 0; n < stats.getBest().genes.size(); ++n)
         cout << right << setw(11) << stats.getBest().genes[n] << ", " ;
 
-    cout << noshowpos << "\b\b) = " <<  stats.getBest().value << " [fit = " << stats.getBest().fitness << "]" << endl;
+    cout << noshowpos << "\b\b) = " <<  stats.getBest().value << " [fit = " << stats.getBest().fitness << "]\n";
 
     // restore format state of cout
     cout.flags(save_state);
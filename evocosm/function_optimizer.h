@@ -23,6 +23,10 @@
 // other elements of Evocosm
 #include "evocosm.h"
 #include "evoreal.h"
+#include "genome_pool.h"
+#include "sampler.h"
+#include "stagnation.h"
+#include "work_stealing.h"
 
 // OpenMP support, if requested
 #if defined(_OPENMP)
@@ -63,9 +67,11 @@ namespace libevocosm
         begins with an empty vector; this is because the number of elements and
         their initialization is application specific. Initialization of the genes
         takes place in the constructor for function_optimizer through a pointer
-        to a user-supplied function.
+        to a user-supplied function. Genes are kept in the genome pool, so
+        a generation's children reuse the memory of the organisms replaced
+        at the last turnover.
     */
-    class function_solution : public organism< vector<double> >, protected fopt_global
+    class function_solution : public organism< pool_vector<double> >, protected fopt_global
     {
     public:
         /*!
@@ -94,7 +100,7 @@ namespace libevocosm
             Creates an empty solution.
         */
         function_solution()
-          : organism< vector<double> >(),
+          : organism< pool_vector<double> >(),
             value(0.0),
             m_minarg(-1.0),
             m_maxarg(1.0),
@@ -108,7 +114,7 @@ namespace libevocosm
             Creates a new solution with an empty vector.
         */
         function_solution(int a_nargs, double a_minarg, double a_maxarg)
-          : organism< vector<double> >(), value(0.0)
+          : organism< pool_vector<double> >(), value(0.0)
         {
             if (a_maxarg < a_minarg)
             {
@@ -126,12 +132,22 @@ namespace libevocosm
                 genes.push_back(g_random.get_real() * m_extent + a_minarg);
         }
 
+        //! Construct from raw genes
+        /*!
+            Constructs a new function solution from a set of genes
+        */
+        function_solution(const pool_vector<double> & a_source)
+          : organism< pool_vector<double> >(a_source), value(0.0)
+        {
+            // nada
+        }
+
         //! Construct from raw genes
         /*!
             Constructs a new function solution from a set of genes
         */
         function_solution(const vector<double> & a_source)
-          : organism< vector<double> >(a_source), value(0.0)
+          : organism< pool_vector<double> >(pool_vector<double>(a_source.begin(), a_source.end())), value(0.0)
         {
             // nada
         }
@@ -141,8 +157,8 @@ namespace libevocosm
             Constructs a function solution from a base-class object.
             \param a_source - The source object
         */
-        function_solution(const organism< vector<double> > & a_source)
-          : organism< vector<double> >(a_source), value(0.0)
+        function_solution(const organism< pool_vector<double> > & a_source)
+          : organism< pool_vector<double> >(a_source), value(0.0)
         {
             // nada
         }
@@ -153,7 +169,7 @@ namespace libevocosm
             \param a_source - The source object
         */
         function_solution(const function_solution & a_source)
-          : organism< vector<double> >(a_source),
+          : organism< pool_vector<double> >(a_source),
             value(a_source.value),
             m_minarg(a_source.m_minarg),
             m_maxarg(a_source.m_maxarg),
@@ -179,7 +195,7 @@ namespace libevocosm
         */
         function_solution & operator = (const function_solution & a_source)
         {
-            organism< vector<double> >::operator = (a_source);
+            organism< pool_vector<double> >::operator = (a_source);
             value = a_source.value;
             m_minarg = a_source.m_minarg;
             m_maxarg = a_source.m_maxarg;
@@ -195,7 +211,7 @@ namespace libevocosm
             \param a_right - Right hand argument for less than operator
             \return <b>true</b> if this organismsfitness if greater than <code>a_right.fitness</code>; <b>false</b> otherwise
         */
-        virtual bool operator < (const organism< vector<double> > & a_right) const
+        virtual bool operator < (const organism< pool_vector<double> > & a_right) const
         {
             return (fitness > a_right.fitness);
         }
@@ -288,7 +304,29 @@ namespace libevocosm
             Creates a new reproducer with a given crossover rate.
         */
         function_reproducer(double p_crossover_rate = 1.0)
-            : m_crossover_rate(p_crossover_rate)
+            : m_crossover_rate(p_crossover_rate),
+              m_sampler(NULL),
+              m_pool(NULL)
+        {
+            // adjust crossover rate if necessary
+            if (m_crossover_rate > 1.0)
+                m_crossover_rate = 1.0;
+            else if (m_crossover_rate < 0.0)
+                m_crossover_rate = 0.0;
+        }
+
+        //! Creation constructor with a parent sampler
+        /*!
+            Creates a new reproducer that picks parents with a given sampler,
+            rather than the default fitness-proportionate roulette wheel.
+            The sampler must exist for the lifetime of the reproducer.
+            \param a_sampler - Picks parents from the population
+            \param p_crossover_rate - Chance of crossover, in [0,1]
+        */
+        function_reproducer(parent_sampler<function_solution> & a_sampler, double p_crossover_rate = 1.0)
+            : m_crossover_rate(p_crossover_rate),
+              m_sampler(&a_sampler),
+              m_pool(NULL)
         {
             // adjust crossover rate if necessary
             if (m_crossover_rate > 1.0)
@@ -303,7 +341,9 @@ namespace libevocosm
             \param a_source - The source object
         */
         function_reproducer(const function_reproducer & a_source)
-            : m_crossover_rate(a_source.m_crossover_rate)
+            : m_crossover_rate(a_source.m_crossover_rate),
+              m_sampler(a_source.m_sampler),
+              m_pool(a_source.m_pool)
         {
             // nada
         }
@@ -326,6 +366,8 @@ namespace libevocosm
         function_reproducer & operator = (const function_reproducer & a_source)
         {
             m_crossover_rate = a_source.m_crossover_rate;
+            m_sampler = a_source.m_sampler;
+            m_pool = a_source.m_pool;
             return *this;
         }
 
@@ -339,6 +381,18 @@ namespace libevocosm
             return m_crossover_rate;
         }
 
+        //! Breed children on a work_stealing_pool
+        /*!
+            Each child draws from its own keyed stream, so the children are
+            the same with or without a pool. The sampler's pick must be safe
+            to call from several threads at once; the library's samplers are.
+            \param a_pool - Runs the breeding; NULL breeds on the calling thread
+        */
+        void set_pool(work_stealing_pool * a_pool)
+        {
+            m_pool = a_pool;
+        }
+
         //! Reproduction for solutions
         /*!
             Breeds new solutions, by cloning or the combination of elements from parent organisms. By
@@ -354,6 +408,15 @@ namespace libevocosm
     private:
         // crossover chance
         double m_crossover_rate;
+
+        // picks parents; NULL selects the default roulette wheel
+        parent_sampler<function_solution> * m_sampler;
+
+        // the default sampler
+        roulette_sampler<function_solution> m_roulette;
+
+        // breeds children; NULL breeds them here
+        work_stealing_pool * m_pool;
     };
 
     //! Defines the test for a population of solutions
@@ -413,7 +476,7 @@ namespace libevocosm
         */
         virtual double test(function_solution & a_organism, bool a_verbose = false) const
         {
-            vector<double> z = m_function(a_organism.genes);
+            vector<double> z = m_function(vector<double>(a_organism.genes.begin(), a_organism.genes.end()));
             a_organism.value   = z[0];
             a_organism.fitness = z[1];
             return a_organism.fitness;
@@ -427,14 +490,11 @@ namespace libevocosm
     //! Reports the state of a population of solutions
     /*!
         A simple analyzer for diaplying information about the populations
-        as it evolves.
+        as it evolves. Evolution stops when the best solution hasn't changed
+        for twenty generations (see stagnation_analyzer).
     */
-    class function_analyzer : public analyzer<function_solution>
+    class function_analyzer : public stagnation_analyzer<function_solution>
     {
-    private:
-        function_solution m_prev_best;
-        size_t m_count;
-
     public:
         //! Constructor
         /*!
@@ -442,13 +502,13 @@ namespace libevocosm
             \param a_listener - a listener for events
         */
         function_analyzer(listener<function_solution> & a_listener, size_t max_iterations)
-            : analyzer<function_solution>(a_listener, max_iterations),
-              m_prev_best(function_solution()),
-              m_count(0)
+            : stagnation_analyzer<function_solution>(a_listener, max_iterations, 1, 20)
         {
             // nada
         }
 
+        using stagnation_analyzer<function_solution>::analyze;
+
         //! Reports on a population
         /*!
             The report method can do almost anything. In most case, it will display
@@ -29,6 +29,9 @@ using namespace std;
 // libevocosm
 #include "evocommon.h"
 #include "machine_tools.h"
+#include "genome_pool.h"
+#include "metrics.h"
+#include "checkpoint.h"
 
 namespace libevocosm
 {
@@ -67,6 +70,14 @@ namespace libevocosm
                 // nada
             }
 
+            //! Restoring constructor
+            tranout_t(checkpoint_reader & a_in)
+              : m_new_state(a_in),
+                m_output(a_in)
+            {
+                // nada
+            }
+
             //! Copy constructor
             tranout_t(const tranout_t & source)
               : m_new_state(source.m_new_state),
@@ -82,6 +93,30 @@ namespace libevocosm
                 m_output    = source.m_output;
                 return *this;
             }
+
+            //! Allocation from the genome pool
+            static void * operator new (size_t a_bytes)
+            {
+                return genome_pool::allocate(a_bytes);
+            }
+
+            //! Allocation from the genome pool
+            static void * operator new [] (size_t a_bytes)
+            {
+                return genome_pool::allocate(a_bytes);
+            }
+
+            //! Return to the genome pool
+            static void operator delete (void * a_block, size_t a_bytes)
+            {
+                genome_pool::deallocate(a_block, a_bytes);
+            }
+
+            //! Return to the genome pool
+            static void operator delete [] (void * a_block, size_t a_bytes)
+            {
+                genome_pool::deallocate(a_block, a_bytes);
+            }
         };
 
         //! Creation constructor
@@ -123,6 +158,20 @@ namespace libevocosm
         */
         fuzzy_machine(const fuzzy_machine<InSize,OutSize> & a_source);
 
+        //! Restoring constructor
+        /*!
+            Creates a fuzzy_machine from a checkpoint written by save. Throws
+            std::runtime_error if the stored machine doesn't fit this type.
+            \param a_in - Checkpoint being read
+        */
+        fuzzy_machine(checkpoint_reader & a_in);
+
+        //! Write to a checkpoint
+        /*!
+            \param a_out - Checkpoint being written
+        */
+        void save(checkpoint_writer & a_out) const;
+
         //! Virtual destructor
         /*!
             Does nothing in the base class; exists to allow destruction of derived
@@ -498,6 +547,92 @@ namespace libevocosm
         deep_copy(a_source);
     }
 
+    //  Restoring constructor
+    template <size_t InSize, size_t OutSize>
+    fuzzy_machine<InSize,OutSize>::fuzzy_machine(checkpoint_reader & a_in)
+      : m_state_table(NULL),
+        m_size(0),
+        m_init_state(0),
+        m_current_state(0),
+        m_output_base(0.0),
+        m_output_range(0.0),
+        m_state_base(0.0),
+        m_state_range(0.0)
+    {
+        size_t in_size  = a_in.get_size();
+        size_t out_size = a_in.get_size();
+        size_t size     = a_in.get_size();
+
+        if ((in_size != InSize) || (out_size != OutSize) || (size < 2))
+            throw std::runtime_error("invalid fuzzy_machine checkpoint");
+
+        m_init_state    = a_in.get_size();
+        m_current_state = a_in.get_size();
+        m_output_base   = a_in.get<double>();
+        m_output_range  = a_in.get<double>();
+        m_state_base    = a_in.get<double>();
+        m_state_range   = a_in.get<double>();
+
+        if ((m_init_state >= size) || (m_current_state >= size))
+            throw std::runtime_error("invalid fuzzy_machine checkpoint");
+
+        // empty table, so a bad checkpoint can be cleaned up part way through
+        m_state_table = new tranout_t ** [size];
+
+        for (size_t s = 0; s < size; ++s)
+        {
+            m_state_table[s] = new tranout_t * [InSize];
+
+            for (size_t i = 0; i < InSize; ++i)
+                m_state_table[s][i] = NULL;
+        }
+
+        m_size = size;
+
+        try
+        {
+            for (size_t s = 0; s < m_size; ++s)
+            {
+                for (size_t i = 0; i < InSize; ++i)
+                {
+                    m_state_table[s][i] = new tranout_t(a_in);
+
+                    if ((m_state_table[s][i]->m_new_state.get_size() != m_size) || (m_state_table[s][i]->m_output.get_size() != OutSize))
+                        throw std::runtime_error("invalid fuzzy_machine checkpoint");
+                }
+            }
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    //  Write to a checkpoint
+    template <size_t InSize, size_t OutSize>
+    void fuzzy_machine<InSize,OutSize>::save(checkpoint_writer & a_out) const
+    {
+        a_out.put_size(InSize);
+        a_out.put_size(OutSize);
+        a_out.put_size(m_size);
+        a_out.put_size(m_init_state);
+        a_out.put_size(m_current_state);
+        a_out.put(m_output_base);
+        a_out.put(m_output_range);
+        a_out.put(m_state_base);
+        a_out.put(m_state_range);
+
+        for (size_t s = 0; s < m_size; ++s)
+        {
+            for (size_t i = 0; i < InSize; ++i)
+            {
+                m_state_table[s][i]->m_new_state.save(a_out);
+                m_state_table[s][i]->m_output.save(a_out);
+            }
+        }
+    }
+
     //  Virtual destructor
     template <size_t InSize, size_t OutSize>
     fuzzy_machine<InSize,OutSize>::~fuzzy_machine()
@@ -549,6 +684,10 @@ namespace libevocosm
         {
             if (g_random.get_real() < a_rate)
             {
+#if defined(EVOCOSM_METRICS)
+                metrics_recorder::count_mutation();
+#endif
+
                 // pick a mutation
                 switch (g_selector.get_index())
                 {
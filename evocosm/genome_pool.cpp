@@ -0,0 +1,293 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <atomic>
+
+#include "genome_pool.h"
+using namespace libevocosm;
+
+namespace
+{
+    // size classes are powers of two from 16 bytes to MAX_BLOCK
+    const size_t MIN_SHIFT   = 4;
+    const size_t CLASS_COUNT = 13;
+
+    // most each thread may cache
+    std::atomic<size_t> g_cache_limit(64 * 1024 * 1024);
+
+    // where other threads return a thread's blocks; outlives the thread, and
+    // is adopted by a later one, so blocks still in use when their owner
+    // exits always have somewhere to go
+    struct mailbox
+    {
+        char m_pad1[64];
+
+        // blocks freed by other threads, linked through their first word
+        std::atomic<void *> m_returned;
+
+        // is a live thread using this mailbox?
+        std::atomic<bool> m_owned;
+
+        // next in the list of all mailboxes
+        mailbox * m_next;
+
+        char m_pad2[64];
+
+        mailbox()
+          : m_returned(NULL),
+            m_owned(true),
+            m_next(NULL)
+        {
+            // nada
+        }
+    };
+
+    // every mailbox ever made; only grows, by the peak number of threads
+    std::atomic<mailbox *> g_mailboxes(NULL);
+
+    // claim an unowned mailbox, or make a new one
+    mailbox * adopt_mailbox()
+    {
+        for (mailbox * box = g_mailboxes.load(std::memory_order_acquire); box != NULL; box = box->m_next)
+        {
+            bool owned = false;
+
+            if (box->m_owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+                return box;
+        }
+
+        mailbox * box = new mailbox;
+        box->m_next = g_mailboxes.load(std::memory_order_relaxed);
+
+        while (!g_mailboxes.compare_exchange_weak(box->m_next, box, std::memory_order_release, std::memory_order_relaxed))
+        {
+            // retry
+        }
+
+        return box;
+    }
+
+    // precedes each pooled block, keeping the block suitably aligned
+    struct block_header
+    {
+        mailbox * m_owner;
+        size_t    m_class;
+    };
+
+    const size_t HEADER_BYTES = 16;
+
+    static_assert(sizeof(block_header) <= HEADER_BYTES, "block_header must fit in HEADER_BYTES");
+
+    inline block_header * header_of(void * a_block)
+    {
+        return reinterpret_cast<block_header *>(static_cast<char *>(a_block) - HEADER_BYTES);
+    }
+
+    // a thread's free lists
+    struct block_cache
+    {
+        // first free block of each class; each free block starts with a pointer to the next
+        void * m_free[CLASS_COUNT];
+
+        // total size of the free blocks
+        size_t m_bytes;
+
+        // where other threads send this thread's blocks
+        mailbox * m_box;
+
+        block_cache()
+          : m_bytes(0),
+            m_box(adopt_mailbox())
+        {
+            for (size_t n = 0; n < CLASS_COUNT; ++n)
+                m_free[n] = NULL;
+        }
+
+        ~block_cache();
+
+        // keep a block, or give it back to the heap if the cache is full
+        void keep(void * a_block, size_t a_class)
+        {
+            size_t size = size_t(1) << (a_class + MIN_SHIFT);
+
+            if (m_bytes + size > g_cache_limit.load(std::memory_order_relaxed))
+            {
+                ::operator delete(header_of(a_block));
+                return;
+            }
+
+            *static_cast<void **>(a_block) = m_free[a_class];
+            m_free[a_class] = a_block;
+            m_bytes += size;
+        }
+
+        // take back the blocks other threads have freed
+        void collect()
+        {
+            void * block = m_box->m_returned.exchange(NULL, std::memory_order_acquire);
+
+            while (block != NULL)
+            {
+                void * next = *static_cast<void **>(block);
+                keep(block, header_of(block)->m_class);
+                block = next;
+            }
+        }
+
+        void release()
+        {
+            collect();
+
+            for (size_t n = 0; n < CLASS_COUNT; ++n)
+            {
+                while (m_free[n] != NULL)
+                {
+                    void * block = m_free[n];
+                    m_free[n] = *static_cast<void **>(block);
+                    ::operator delete(header_of(block));
+                }
+            }
+
+            m_bytes = 0;
+        }
+    };
+
+    thread_local block_cache t_cache;
+
+    // set once a thread's cache is gone, so genomes destroyed later in thread
+    // (or program) shutdown go straight to the heap
+    thread_local bool t_cache_gone = false;
+
+    block_cache::~block_cache()
+    {
+        release();
+        m_box->m_owned.store(false, std::memory_order_release);
+        t_cache_gone = true;
+    }
+
+    // class of a block size
+    inline size_t size_class(size_t a_bytes)
+    {
+        size_t c = 0;
+
+        while ((size_t(1) << (c + MIN_SHIFT)) < a_bytes)
+            ++c;
+
+        return c;
+    }
+
+    // a new block from the heap
+    inline void * new_block(mailbox * a_owner, size_t a_class)
+    {
+        void * raw = ::operator new(HEADER_BYTES + (size_t(1) << (a_class + MIN_SHIFT)));
+        block_header * header = static_cast<block_header *>(raw);
+        header->m_owner = a_owner;
+        header->m_class = a_class;
+        return static_cast<char *>(raw) + HEADER_BYTES;
+    }
+}
+
+// allocate memory
+void * genome_pool::allocate(size_t a_bytes)
+{
+    if (a_bytes > MAX_BLOCK)
+        return ::operator new(a_bytes);
+
+    size_t c = size_class(a_bytes);
+
+    if (t_cache_gone)
+        return new_block(NULL, c);
+
+    block_cache & cache = t_cache;
+
+    if (cache.m_free[c] == NULL && cache.m_box->m_returned.load(std::memory_order_relaxed) != NULL)
+        cache.collect();
+
+    void * block = cache.m_free[c];
+
+    if (block == NULL)
+        return new_block(cache.m_box, c);
+
+    cache.m_free[c] = *static_cast<void **>(block);
+    cache.m_bytes -= size_t(1) << (c + MIN_SHIFT);
+    return block;
+}
+
+// free memory
+void genome_pool::deallocate(void * a_block, size_t a_bytes)
+{
+    if (a_block == NULL)
+        return;
+
+    if (a_bytes > MAX_BLOCK)
+    {
+        ::operator delete(a_block);
+        return;
+    }
+
+    block_header * header = header_of(a_block);
+
+    if (t_cache_gone)
+    {
+        ::operator delete(header);
+        return;
+    }
+
+    block_cache & cache = t_cache;
+    mailbox * owner = header->m_owner;
+
+    // another thread's block goes home, so the thread that breeds a
+    // population gets back the memory when another thread turns it over
+    if ((owner != NULL) && (owner != cache.m_box))
+    {
+        void * head = owner->m_returned.load(std::memory_order_relaxed);
+
+        do
+        {
+            *static_cast<void **>(a_block) = head;
+        }
+        while (!owner->m_returned.compare_exchange_weak(head, a_block, std::memory_order_release, std::memory_order_relaxed));
+
+        return;
+    }
+
+    header->m_owner = cache.m_box;
+    cache.keep(a_block, header->m_class);
+}
+
+// return cached blocks to the heap
+void genome_pool::release()
+{
+    if (!t_cache_gone)
+        t_cache.release();
+}
+
+// bytes cached by this thread
+size_t genome_pool::get_cached_bytes()
+{
+    return t_cache_gone ? 0 : t_cache.m_bytes;
+}
+
+// set cache limit
+void genome_pool::set_cache_limit(size_t a_bytes)
+{
+    g_cache_limit.store(a_bytes, std::memory_order_relaxed);
+}
+
+// get cache limit
+size_t genome_pool::get_cache_limit()
+{
+    return g_cache_limit.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,150 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_GENOME_POOL_H)
+#define LIBEVOCOSM_GENOME_POOL_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace libevocosm
+{
+    //! Per-thread recycling of genome memory
+    /*!
+        A generation frees nearly as many genomes as it creates, and all of
+        about the same sizes. Rather than return them to the heap, where
+        threads contend for locks, each thread keeps the blocks it frees in
+        lists by size class (powers of two from 16 bytes to 64 KB), and
+        takes new genomes from those lists first. Once a run is warmed up,
+        breeding a generation reuses the memory released at the previous
+        turnover, and touches the heap only to grow.
+        <p>
+        Larger blocks go straight to the heap. A thread caches no more than
+        the cache limit; its blocks go back to the heap when it exits, or
+        when it calls release. Memory freed by a thread other than the one
+        that allocated it goes back to the allocating thread, which takes it
+        up the next time a list comes up empty; so pool threads that breed
+        children get their memory back when the master turns them over.
+        Each cached block carries a 16-byte header naming its owner.
+    */
+    class genome_pool
+    {
+    public:
+        //! Largest block kept in the cache
+        static const size_t MAX_BLOCK = 65536;
+
+        //! Allocate memory
+        /*!
+            \param a_bytes - Number of bytes needed
+            \return Memory suitably aligned for any fundamental type
+        */
+        static void * allocate(size_t a_bytes);
+
+        //! Free memory
+        /*!
+            \param a_block - Memory from allocate
+            \param a_bytes - The size passed to allocate
+        */
+        static void deallocate(void * a_block, size_t a_bytes);
+
+        //! Return the calling thread's cached blocks to the heap
+        static void release();
+
+        //! Number of bytes cached by the calling thread
+        static size_t get_cached_bytes();
+
+        //! Set the most each thread may cache
+        /*!
+            Threads over the new limit shed blocks as they free them.
+            \param a_bytes - Limit per thread; zero disables caching
+        */
+        static void set_cache_limit(size_t a_bytes);
+
+        //! Get the most each thread may cache
+        static size_t get_cache_limit();
+    };
+
+    //! A standard allocator that draws from the genome pool
+    /*!
+        Stateless, so any two instances are interchangeable, and containers
+        using it can be copied and swapped freely between threads.
+        \param Type - The type being allocated
+    */
+    template <typename Type>
+    class pool_allocator
+    {
+    public:
+        //! The type being allocated
+        typedef Type value_type;
+
+        //! Constructor
+        pool_allocator()
+        {
+            // nada
+        }
+
+        //! Converting constructor
+        template <typename Other>
+        pool_allocator(const pool_allocator<Other> &)
+        {
+            // nada
+        }
+
+        //! Allocate space for objects
+        /*!
+            \param a_count - Number of objects
+        */
+        Type * allocate(size_t a_count)
+        {
+            if (a_count > std::numeric_limits<size_t>::max() / sizeof(Type))
+                throw std::bad_alloc();
+
+            return static_cast<Type *>(genome_pool::allocate(a_count * sizeof(Type)));
+        }
+
+        //! Free space for objects
+        /*!
+            \param a_block - Space from allocate
+            \param a_count - The count passed to allocate
+        */
+        void deallocate(Type * a_block, size_t a_count)
+        {
+            genome_pool::deallocate(a_block, a_count * sizeof(Type));
+        }
+    };
+
+    //! All pool allocators are equal
+    template <typename Type1, typename Type2>
+    inline bool operator == (const pool_allocator<Type1> &, const pool_allocator<Type2> &)
+    {
+        return true;
+    }
+
+    //! All pool allocators are equal
+    template <typename Type1, typename Type2>
+    inline bool operator != (const pool_allocator<Type1> &, const pool_allocator<Type2> &)
+    {
+        return false;
+    }
+
+    //! A vector whose elements live in the genome pool
+    template <typename Type>
+    using pool_vector = std::vector< Type, pool_allocator<Type> >;
+};
+
+#endif
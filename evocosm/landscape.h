@@ -18,6 +18,7 @@
 
 // libevocosm
 #include "organism.h"
+#include "metrics.h"
 
 #ifdef _OPENMP
 #include "omp.h"
@@ -102,7 +103,13 @@ namespace libevocosm
 
                 for (int n = 0; n < (int)a_population.size(); ++n)
                 {
+#if defined(EVOCOSM_METRICS)
+                    uint64_t start = metrics_recorder::now();
                     a_population[n].fitness = test(a_population[n]);
+                    metrics_recorder::record_evaluation(metrics_recorder::now() - start);
+#else
+                    a_population[n].fitness = test(a_population[n]);
+#endif
                     result += a_population[n].fitness;
                 }
 
@@ -20,6 +20,10 @@
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <vector>
+
+// libevocosm
+#include "metrics.h"
 
 // Windows
 #if defined(_MSC_VER)
@@ -30,6 +34,8 @@
 
 namespace libevocosm
 {
+    using std::vector;
+
     template<typename T> class population;
 
     //! An abstract interface defining a listener
@@ -99,6 +105,20 @@ namespace libevocosm
                 rest on the seventh day.
             */
             virtual void run_complete(const vector<OrganismType> & a_population) = 0;
+
+            //! Report generation metrics
+            /*!
+                Invoked at the end of each completed generation by an evocosm
+                built with EVOCOSM_METRICS defined; otherwise never called.
+                A generation stopped part way, by the scheduler or an
+                exception, is not reported. The default implementation
+                ignores the report, so existing listeners need not change.
+                \param a_metrics Timings and counts for the generation
+            */
+            virtual void ping_generation_metrics(const generation_metrics & a_metrics)
+            {
+                // do nothing
+            }
     };
 
     //! An listener implementation that ignores all events
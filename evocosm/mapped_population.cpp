@@ -0,0 +1,290 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_population.h"
+using namespace libevocosm;
+
+// identifies a population file
+static const char MAPPED_MAGIC[8] = { 'E', 'V', 'O', 'P', 'O', 'P', '0', '3' };
+
+// the header and both generations start on boundaries that suit any common
+// page size, since madvise and msync work on whole pages
+static const size_t HEADER_SIZE = 65536;
+
+// population file header
+struct mapped_header
+{
+    char                   magic[8];
+    uint64_t               size;
+    uint64_t               dimension;
+    uint64_t               generation;
+    uint64_t               current;
+    unsigned long long int random_state[prng::STATE_WORDS];
+};
+
+// constructor
+mapped_population::mapped_population(const std::string & a_filename, size_t a_size, size_t a_dimension)
+  : m_fd(-1),
+    m_base(NULL),
+    m_length(0),
+    m_region(0),
+    m_size(a_size),
+    m_dimension(a_dimension),
+    m_stride(a_dimension + 1),
+    m_current(NULL),
+    m_next(NULL),
+    m_recovered(false)
+{
+    if ((m_size < 2) || (m_dimension < 1))
+        throw std::runtime_error("invalid mapped_population creation parameters");
+
+    // each generation's region starts on a page boundary
+    m_region = (m_size * m_stride * sizeof(double) + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+    m_length = HEADER_SIZE + 2 * m_region;
+
+    m_fd = open(a_filename.c_str(), O_RDWR | O_CREAT, 0644);
+
+    if (m_fd < 0)
+        throw std::runtime_error("unable to open population file " + a_filename);
+
+    struct stat info;
+    fstat(m_fd, &info);
+
+    bool existing = (info.st_size > 0);
+
+    if (!existing && (ftruncate(m_fd, static_cast<off_t>(m_length)) != 0))
+    {
+        close(m_fd);
+        throw std::runtime_error("unable to size population file " + a_filename);
+    }
+
+    if (existing && (static_cast<size_t>(info.st_size) != m_length))
+    {
+        close(m_fd);
+        throw std::runtime_error("population file " + a_filename + " has a different size or dimension");
+    }
+
+    void * base = mmap(NULL, m_length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+
+    if (base == MAP_FAILED)
+    {
+        close(m_fd);
+        throw std::runtime_error("unable to map population file " + a_filename);
+    }
+
+    m_base = static_cast<unsigned char *>(base);
+
+    mapped_header * header = reinterpret_cast<mapped_header *>(m_base);
+
+    if (existing)
+    {
+        if ((memcmp(header->magic, MAPPED_MAGIC, sizeof(MAPPED_MAGIC)) != 0)
+         || (header->size != m_size)
+         || (header->dimension != m_dimension)
+         || (header->current > 1))
+        {
+            munmap(m_base, m_length);
+            close(m_fd);
+            throw std::runtime_error("population file " + a_filename + " is damaged or doesn't match");
+        }
+
+        // resume the random sequence where the last commit left it
+        g_random.set_state(header->random_state);
+
+        // a file that never got its first generation starts over
+        m_recovered = (header->generation > 0);
+    }
+    else
+    {
+        memcpy(header->magic, MAPPED_MAGIC, sizeof(MAPPED_MAGIC));
+        header->size       = m_size;
+        header->dimension  = m_dimension;
+        header->generation = 0;
+        header->current    = 0;
+        g_random.get_state(header->random_state);
+    }
+
+    locate();
+}
+
+// destructor
+mapped_population::~mapped_population()
+{
+    munmap(m_base, m_length);
+    close(m_fd);
+}
+
+// generations committed
+size_t mapped_population::generation() const
+{
+    return static_cast<size_t>(reinterpret_cast<const mapped_header *>(m_base)->generation);
+}
+
+// find the generations
+void mapped_population::locate()
+{
+    size_t current = static_cast<size_t>(reinterpret_cast<mapped_header *>(m_base)->current);
+
+    m_current = reinterpret_cast<double *>(m_base + HEADER_SIZE + current * m_region);
+    m_next    = reinterpret_cast<double *>(m_base + HEADER_SIZE + (1 - current) * m_region);
+}
+
+// access hints
+void mapped_population::advise(access_pattern a_pattern)
+{
+    madvise(m_current, m_region, (a_pattern == ACCESS_SEQUENTIAL) ? MADV_SEQUENTIAL : MADV_RANDOM);
+}
+
+// make the next generation current
+void mapped_population::commit()
+{
+    // the generation must be on disk before the header points at it
+    msync(m_next, m_region, MS_SYNC);
+
+    mapped_header * header = reinterpret_cast<mapped_header *>(m_base);
+    header->current = 1 - header->current;
+    ++header->generation;
+    g_random.get_state(header->random_state);
+
+    msync(m_base, HEADER_SIZE, MS_SYNC);
+
+    // the old generation will be overwritten by the next breeding; its contents needn't stay resident
+    madvise(m_current, m_region, MADV_DONTNEED);
+
+    locate();
+
+    // children are written in order
+    madvise(m_next, m_region, MADV_SEQUENTIAL);
+}
+
+// constructor
+mapped_optimizer::mapped_optimizer(mapped_population & a_population,
+                                   t_mapped_function * a_function,
+                                   double              a_mutation_rate,
+                                   double              a_crossover_rate,
+                                   size_t              a_tournament_size)
+  : m_population(a_population),
+    m_function(a_function),
+    m_mutation_rate(a_mutation_rate),
+    m_crossover_rate(a_crossover_rate),
+    m_tournament_size(a_tournament_size > 0 ? a_tournament_size : 1),
+    m_best(0)
+{
+    // nada
+}
+
+// random first generation
+void mapped_optimizer::initialize(double a_minarg, double a_maxarg)
+{
+    if (m_population.was_recovered())
+        return;
+
+    double extent = a_maxarg - a_minarg;
+
+    for (size_t i = 0; i < m_population.size(); ++i)
+    {
+        double * genes = m_population.next_genes(i);
+
+        for (size_t n = 0; n < m_population.dimension(); ++n)
+            genes[n] = g_random.get_real() * extent + a_minarg;
+
+        m_population.next_fitness(i) = 0.0;
+    }
+
+    m_population.commit();
+}
+
+// test fitness, in order
+size_t mapped_optimizer::test()
+{
+    m_population.advise(mapped_population::ACCESS_SEQUENTIAL);
+
+    m_best = 0;
+
+    for (size_t i = 0; i < m_population.size(); ++i)
+    {
+        double f = m_function(m_population.genes(i), m_population.dimension());
+        m_population.fitness(i) = f;
+
+        if (f > m_population.fitness(m_best))
+            m_best = i;
+    }
+
+    return m_best;
+}
+
+// pick a parent
+size_t mapped_optimizer::tournament()
+{
+    size_t winner = g_random.get_index(m_population.size());
+
+    for (size_t n = 1; n < m_tournament_size; ++n)
+    {
+        size_t challenger = g_random.get_index(m_population.size());
+
+        if (m_population.fitness(challenger) > m_population.fitness(winner))
+            winner = challenger;
+    }
+
+    return winner;
+}
+
+// breed the next generation
+void mapped_optimizer::breed()
+{
+    // parents are scattered; children are written in order
+    m_population.advise(mapped_population::ACCESS_RANDOM);
+
+    size_t dimension = m_population.dimension();
+
+    // elitism: the best survives unchanged
+    memcpy(m_population.next_genes(0), m_population.genes(m_best), sizeof(double) * dimension);
+    m_population.next_fitness(0) = m_population.fitness(m_best);
+
+    for (size_t i = 1; i < m_population.size(); ++i)
+    {
+        double * child = m_population.next_genes(i);
+        const double * parent1 = m_population.genes(tournament());
+
+        if (g_random.get_real() < m_crossover_rate)
+        {
+            const double * parent2 = m_population.genes(tournament());
+
+            for (size_t n = 0; n < dimension; ++n)
+                child[n] = g_evoreal.crossover(parent1[n], parent2[n]);
+        }
+        else
+            memcpy(child, parent1, sizeof(double) * dimension);
+
+        for (size_t n = 0; n < dimension; ++n)
+        {
+            if (g_random.get_real() <= m_mutation_rate)
+                child[n] = g_evoreal.mutate(child[n]);
+        }
+
+        m_population.next_fitness(i) = 0.0;
+    }
+
+    m_population.commit();
+}
@@ -0,0 +1,259 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_MAPPED_POPULATION_H)
+#define LIBEVOCOSM_MAPPED_POPULATION_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <string>
+
+// libevocosm
+#include "evocommon.h"
+#include "function_optimizer.h"
+
+namespace libevocosm
+{
+    //! A population of real-valued genomes kept in a memory-mapped file
+    /*!
+        For populations too large to keep on the heap as organisms, a
+        mapped_population stores fixed-stride records in a file. Each record
+        holds a fitness followed by <i>dimension</i> genes, all doubles. The
+        file holds two generations: the current one, which is read, and the
+        next one, which is written by breeding. Committing the next generation
+        syncs it to disk, then flips a field in the file header; an
+        interrupted run therefore always finds a complete generation when it
+        reopens the file.
+        <p>
+        The header also holds the state of the shared random number generator
+        as of the last commit, which is restored on recovery, so a recovered
+        run breeds exactly the generation the interrupted one would have.
+        <p>
+        The operating system pages records in and out as they are used; the
+        advise function tells it whether upcoming access is sequential (as in
+        fitness testing) or random (as in choosing parents). Requires POSIX
+        <i>mmap</i>.
+    */
+    class mapped_population : protected globals
+    {
+    public:
+        //! How records are about to be accessed
+        enum access_pattern
+        {
+            ACCESS_SEQUENTIAL,  //!< In order, once each
+            ACCESS_RANDOM       //!< Scattered
+        };
+
+        //! Creation constructor
+        /*!
+            Opens an existing population file, or creates a new one. An
+            existing file must have been made with the same size and
+            dimension, or std::runtime_error is thrown. Opening an existing
+            file restores the shared random number generator. A new file is
+            filled with zeros; use was_recovered to tell whether it needs to be
+            initialized.
+            \param a_filename - Name of the population file
+            \param a_size - Number of organisms
+            \param a_dimension - Number of genes per organism
+        */
+        mapped_population(const std::string & a_filename, size_t a_size, size_t a_dimension);
+
+        //! Destructor
+        /*!
+            Unmaps and closes the file. Uncommitted changes to the next
+            generation may or may not reach the disk.
+        */
+        ~mapped_population();
+
+        //! Was a population recovered from an existing file?
+        /*!
+            \return <b>true</b> if the file held at least one committed generation
+        */
+        bool was_recovered() const
+        {
+            return m_recovered;
+        }
+
+        //! Get number of organisms
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        //! Get number of genes per organism
+        size_t dimension() const
+        {
+            return m_dimension;
+        }
+
+        //! Get number of generations committed
+        size_t generation() const;
+
+        //! Get the fitness of an organism in the current generation
+        double & fitness(size_t a_index)
+        {
+            return m_current[a_index * m_stride];
+        }
+
+        //! Get the genes of an organism in the current generation
+        double * genes(size_t a_index)
+        {
+            return m_current + a_index * m_stride + 1;
+        }
+
+        //! Get the fitness of an organism in the next generation
+        double & next_fitness(size_t a_index)
+        {
+            return m_next[a_index * m_stride];
+        }
+
+        //! Get the genes of an organism in the next generation
+        double * next_genes(size_t a_index)
+        {
+            return m_next + a_index * m_stride + 1;
+        }
+
+        //! Describe upcoming access to the current generation
+        /*!
+            \param a_pattern - How records will be read
+        */
+        void advise(access_pattern a_pattern);
+
+        //! Make the next generation current
+        /*!
+            Syncs the next generation to disk, records it (and the random
+            number generator state) in the header, and releases the pages of
+            the old generation.
+        */
+        void commit();
+
+    private:
+        // not copyable
+        mapped_population(const mapped_population &);
+        mapped_population & operator = (const mapped_population &);
+
+        // point m_current and m_next at the right regions
+        void locate();
+
+        // file descriptor
+        int m_fd;
+
+        // the mapping
+        unsigned char * m_base;
+
+        // size of the mapping
+        size_t m_length;
+
+        // bytes in a generation's region
+        size_t m_region;
+
+        // number of organisms
+        size_t m_size;
+
+        // genes per organism
+        size_t m_dimension;
+
+        // doubles per record
+        size_t m_stride;
+
+        // records of the current generation
+        double * m_current;
+
+        // records of the next generation
+        double * m_next;
+
+        // did the file hold a committed generation?
+        bool m_recovered;
+    };
+
+    //! A function optimizer that evolves a mapped_population
+    /*!
+        The same algorithm as function_optimizer -- crossover and mutation
+        by evoreal -- restructured to stream through a mapped_population:
+        fitness testing reads each record once, in order, and breeding writes
+        each child once, in order, while parents are picked by tournament.
+        The best organism always survives unchanged. No organisms are
+        allocated on the heap.
+    */
+    class mapped_optimizer : protected globals, protected fopt_global
+    {
+    public:
+        //! Type of function being optimized
+        /*!
+            Computes the fitness of a set of arguments; larger is better.
+        */
+        typedef double t_mapped_function(const double * a_args, size_t a_dimension);
+
+        //! Creation constructor
+        /*!
+            \param a_population - Population to evolve; must outlive the optimizer
+            \param a_function - Fitness function
+            \param a_mutation_rate - Chance of mutating each gene of a child
+            \param a_crossover_rate - Chance that a child has two parents
+            \param a_tournament_size - Organisms competing to be each parent
+        */
+        mapped_optimizer(mapped_population & a_population,
+                         t_mapped_function * a_function,
+                         double              a_mutation_rate,
+                         double              a_crossover_rate,
+                         size_t              a_tournament_size = 2);
+
+        //! Randomize a new population
+        /*!
+            Fills the genes of a population that was not recovered from a
+            file with values in [a_minarg,a_maxarg), and commits them as
+            generation zero. Does nothing to a recovered population.
+            \param a_minarg - Minimum gene value
+            \param a_maxarg - Maximum gene value
+        */
+        void initialize(double a_minarg, double a_maxarg);
+
+        //! Test the current generation
+        /*!
+            \return Index of the fittest organism
+        */
+        size_t test();
+
+        //! Breed and commit the next generation
+        /*!
+            Must follow test.
+        */
+        void breed();
+
+    private:
+        // pick a parent
+        size_t tournament();
+
+        // the population
+        mapped_population & m_population;
+
+        // fitness function
+        t_mapped_function * m_function;
+
+        // chance of mutating a gene
+        double m_mutation_rate;
+
+        // chance of crossover
+        double m_crossover_rate;
+
+        // organisms per tournament
+        size_t m_tournament_size;
+
+        // fittest organism found by test
+        size_t m_best;
+    };
+};
+
+#endif
@@ -0,0 +1,129 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <chrono>
+#include <cstring>
+
+#include "metrics.h"
+using namespace libevocosm;
+
+// the recorder for the generation in progress on each thread
+thread_local metrics_recorder * metrics_recorder::g_active = NULL;
+
+// zero all measurements
+void generation_metrics::clear()
+{
+    memset(this, 0, sizeof(generation_metrics));
+}
+
+// phase names, for reports
+const char * generation_metrics::phase_name(generation_phase a_phase)
+{
+    static const char * names[PHASE_COUNT] =
+    {
+        "test", "generation_end", "analyze", "scale", "select", "breed", "mutate", "turnover"
+    };
+
+    return (a_phase < PHASE_COUNT) ? names[a_phase] : "unknown";
+}
+
+// constructor
+metrics_recorder::metrics_recorder()
+  : m_phase_start(0),
+    m_phase_allocations(0),
+    m_generation_start(0)
+{
+    m_metrics.clear();
+}
+
+// destructor
+metrics_recorder::~metrics_recorder()
+{
+    if (g_active == this)
+        g_active = NULL;
+}
+
+// start a generation
+void metrics_recorder::begin_generation(size_t a_iteration)
+{
+    m_metrics.clear();
+    m_metrics.iteration = a_iteration;
+    m_generation_start = now();
+    g_active = this;
+}
+
+// finish a generation
+const generation_metrics & metrics_recorder::end_generation()
+{
+    m_metrics.total_ns = now() - m_generation_start;
+
+    if (g_active == this)
+        g_active = NULL;
+
+    return m_metrics;
+}
+
+// abandon a generation
+void metrics_recorder::cancel_generation()
+{
+    if (g_active == this)
+        g_active = NULL;
+}
+
+// one fitness evaluation
+void metrics_recorder::record_evaluation(uint64_t a_ns)
+{
+    if (g_active == NULL)
+        return;
+
+    // floor(log2(a_ns)), capped at the last bucket
+    size_t bucket = 0;
+
+    while ((a_ns >>= 1) != 0)
+        ++bucket;
+
+    if (bucket >= generation_metrics::HISTOGRAM_BUCKETS)
+        bucket = generation_metrics::HISTOGRAM_BUCKETS - 1;
+
+    ++g_active->m_metrics.evaluations;
+    ++g_active->m_metrics.evaluation_histogram[bucket];
+}
+
+// children bred
+void metrics_recorder::count_children(size_t a_count)
+{
+    if (g_active != NULL)
+        g_active->m_metrics.children += a_count;
+}
+
+// one mutation
+void metrics_recorder::count_mutation()
+{
+    if (g_active != NULL)
+        ++g_active->m_metrics.mutations;
+}
+
+// one allocation
+void metrics_recorder::count_allocation()
+{
+    if (g_active != NULL)
+        ++g_active->m_metrics.allocations;
+}
+
+// monotonic clock
+uint64_t metrics_recorder::now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
@@ -0,0 +1,274 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_METRICS_H)
+#define LIBEVOCOSM_METRICS_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <cstdint>
+
+namespace libevocosm
+{
+    //! The phases of a generation
+    /*!
+        Identifies the steps of evocosm::run_generation for timing purposes.
+    */
+    enum generation_phase
+    {
+        PHASE_TEST,           //!< Fitness testing by the landscape
+        PHASE_GENERATION_END, //!< The listener's ping_generation_end
+        PHASE_ANALYZE,        //!< Analysis of the population
+        PHASE_SCALE,          //!< Fitness scaling
+        PHASE_SELECT,         //!< Selection of survivors
+        PHASE_BREED,          //!< Reproduction
+        PHASE_MUTATE,         //!< Mutation of children
+        PHASE_TURNOVER,       //!< Replacement of the population
+        PHASE_COUNT           //!< Number of phases (not a phase)
+    };
+
+    //! Measurements of a single generation
+    /*!
+        Filled in by an evocosm built with EVOCOSM_METRICS defined, and
+        delivered to listener::ping_generation_metrics at the end of each
+        generation. Times are in nanoseconds, from a monotonic clock.
+    */
+    struct generation_metrics
+    {
+        //! Number of buckets in the evaluation time histogram
+        static const size_t HISTOGRAM_BUCKETS = 32;
+
+        //! One-based generation number
+        size_t iteration;
+
+        //! Time spent in each phase
+        uint64_t phase_ns[PHASE_COUNT];
+
+        //! Time for the whole generation
+        uint64_t total_ns;
+
+        //! Number of fitness evaluations
+        uint64_t evaluations;
+
+        //! Number of children bred
+        uint64_t children;
+
+        //! Number of mutations applied
+        uint64_t mutations;
+
+        //! Number of heap allocations, when an allocation hook reports them
+        /*!
+            The library never replaces <i>operator new</i>; a program that
+            wants allocations counted replaces it, and calls
+            metrics_recorder::count_allocation for each allocation.
+        */
+        uint64_t allocations;
+
+        //! Heap allocations made in each phase, when a hook reports them
+        uint64_t phase_allocations[PHASE_COUNT];
+
+        //! Histogram of per-organism evaluation times
+        /*!
+            Bucket <i>b</i> counts evaluations taking at least 2^b and less
+            than 2^(b+1) nanoseconds; the last bucket also holds anything
+            longer. Only landscapes that use the default population test
+            report individual evaluations.
+        */
+        uint64_t evaluation_histogram[HISTOGRAM_BUCKETS];
+
+        //! Zero all measurements
+        void clear();
+
+        //! Get the name of a phase
+        /*!
+            \param a_phase - A phase identifier
+            \return A short, lower-case name for the phase
+        */
+        static const char * phase_name(generation_phase a_phase);
+    };
+
+    //! Collects generation metrics
+    /*!
+        An evocosm built with EVOCOSM_METRICS defined owns one of these, and
+        marks the phases of each generation with it. While a generation is
+        in progress, its recorder is "active", and the static counting
+        functions add to it; components such as landscapes and mutators
+        call those functions, inside <code>#if defined(EVOCOSM_METRICS)</code>
+        blocks, to report work the evocosm can't see. Each thread has its
+        own active recorder, so evocosms on different threads (such as the
+        islands of an archipelago) count separately; work a generation
+        hands to other threads isn't counted.
+        <p>
+        Without EVOCOSM_METRICS, nothing calls into this class, and no
+        instrumentation is compiled. The macro must be defined the same way
+        for the library and for every program that uses it.
+    */
+    class metrics_recorder
+    {
+    public:
+        //! Constructor
+        metrics_recorder();
+
+        //! Destructor
+        /*!
+            Deactivates this recorder if a generation was left unfinished.
+        */
+        ~metrics_recorder();
+
+        //! Start measuring a generation
+        /*!
+            Clears all measurements and makes this recorder active.
+            \param a_iteration - One-based generation number
+        */
+        void begin_generation(size_t a_iteration);
+
+        //! Finish measuring a generation
+        /*!
+            Records the total time, and deactivates this recorder.
+            \return Measurements for the generation
+        */
+        const generation_metrics & end_generation();
+
+        //! Abandon a generation
+        /*!
+            Deactivates this recorder without finishing its measurements;
+            for a generation that stopped part way through.
+        */
+        void cancel_generation();
+
+        //! Mark the start of a phase
+        /*!
+            \param a_phase - The phase beginning
+        */
+        void begin_phase(generation_phase a_phase)
+        {
+            m_phase_start = now();
+            m_phase_allocations = m_metrics.allocations;
+        }
+
+        //! Mark the end of a phase
+        /*!
+            \param a_phase - The phase ending
+        */
+        void end_phase(generation_phase a_phase)
+        {
+            m_metrics.phase_ns[a_phase] += now() - m_phase_start;
+            m_metrics.phase_allocations[a_phase] += m_metrics.allocations - m_phase_allocations;
+        }
+
+        //! Get the measurements so far
+        generation_metrics & metrics()
+        {
+            return m_metrics;
+        }
+
+        //! Record one fitness evaluation
+        /*!
+            \param a_ns - Time taken by the evaluation, in nanoseconds
+        */
+        static void record_evaluation(uint64_t a_ns);
+
+        //! Count children bred
+        /*!
+            \param a_count - Number of children
+        */
+        static void count_children(size_t a_count);
+
+        //! Count a mutation
+        static void count_mutation();
+
+        //! Count a heap allocation
+        static void count_allocation();
+
+        //! Read the monotonic clock
+        /*!
+            \return Nanoseconds since an arbitrary epoch
+        */
+        static uint64_t now();
+
+    private:
+        // measurements for the current generation
+        generation_metrics m_metrics;
+
+        // start of the current phase
+        uint64_t m_phase_start;
+
+        // allocations when the current phase started
+        uint64_t m_phase_allocations;
+
+        // start of the current generation
+        uint64_t m_generation_start;
+
+        // recorder for the generation in progress on this thread, if any
+        static thread_local metrics_recorder * g_active;
+    };
+
+    //! Measures one generation with a metrics_recorder
+    /*!
+        Begins the generation when constructed. A generation that reaches
+        finish is reported; one left any other way (stopped by a scheduler,
+        or by an exception) is cancelled by the destructor, so the recorder
+        never stays active on the thread, and the partial generation is not
+        reported.
+    */
+    class generation_recording
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_recorder - Recorder for the generation
+            \param a_iteration - One-based generation number
+        */
+        generation_recording(metrics_recorder & a_recorder, size_t a_iteration)
+          : m_recorder(a_recorder),
+            m_finished(false)
+        {
+            m_recorder.begin_generation(a_iteration);
+        }
+
+        //! Destructor
+        /*!
+            Cancels the generation unless it was finished.
+        */
+        ~generation_recording()
+        {
+            if (!m_finished)
+                m_recorder.cancel_generation();
+        }
+
+        //! Finish the generation
+        /*!
+            \return Measurements for the generation
+        */
+        const generation_metrics & finish()
+        {
+            m_finished = true;
+            return m_recorder.end_generation();
+        }
+
+    private:
+        // not copyable
+        generation_recording(const generation_recording &);
+        generation_recording & operator = (const generation_recording &);
+
+        // the recorder
+        metrics_recorder & m_recorder;
+
+        // was finish called?
+        bool m_finished;
+    };
+};
+
+#endif
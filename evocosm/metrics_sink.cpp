@@ -0,0 +1,176 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "metrics_sink.h"
+using namespace libevocosm;
+
+// identifies a binary metrics file
+static const char METRICS_MAGIC[8] = { 'E', 'V', 'O', 'M', 'E', 'T', 'R', 'C' };
+
+// binary file header
+struct metrics_file_header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t phase_count;
+    uint32_t reserved;
+};
+
+// constructor
+metrics_sink::metrics_sink(const std::string & a_filename, file_format a_format, size_t a_capacity)
+  : m_file(fopen(a_filename.c_str(), (a_format == FORMAT_BINARY) ? "wb" : "w")),
+    m_format(a_format),
+    m_queue(a_capacity),
+    m_stalls(0),
+    m_stop(false),
+    m_writer()
+{
+    if (m_file == NULL)
+        throw std::runtime_error("unable to open metrics file " + a_filename);
+
+    // the writer batches output; big buffers mean few system calls
+    setvbuf(m_file, NULL, _IOFBF, 1 << 16);
+
+    if (m_format == FORMAT_BINARY)
+    {
+        metrics_file_header header;
+        memcpy(header.magic, METRICS_MAGIC, sizeof(METRICS_MAGIC));
+        header.version     = VERSION;
+        header.record_size = sizeof(metrics_record);
+        header.phase_count = PHASE_COUNT;
+        header.reserved    = 0;
+        fwrite(&header, sizeof(header), 1, m_file);
+    }
+    else
+        write_csv_header(m_file);
+
+    m_writer = std::thread(&metrics_sink::drain, this);
+}
+
+// destructor
+metrics_sink::~metrics_sink()
+{
+    m_stop.store(true, std::memory_order_release);
+    m_writer.join();
+    fclose(m_file);
+}
+
+// queue a record
+void metrics_sink::write(const metrics_record & a_record)
+{
+    while (!m_queue.try_push(a_record))
+    {
+        ++m_stalls;
+        std::this_thread::yield();
+    }
+}
+
+// writer thread
+void metrics_sink::drain()
+{
+    metrics_record record;
+    bool idle = false;
+
+    for (;;)
+    {
+        if (m_queue.try_pop(record))
+        {
+            emit(record);
+            idle = false;
+        }
+        else if (m_stop.load(std::memory_order_acquire))
+        {
+            // anything pushed before the stop request is visible now
+            while (m_queue.try_pop(record))
+                emit(record);
+
+            break;
+        }
+        else
+        {
+            // flush once when the queue runs dry, so readers see progress
+            if (!idle)
+            {
+                fflush(m_file);
+                idle = true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    fflush(m_file);
+}
+
+// write a record
+void metrics_sink::emit(const metrics_record & a_record)
+{
+    if (m_format == FORMAT_BINARY)
+        fwrite(&a_record, sizeof(metrics_record), 1, m_file);
+    else
+        write_csv(m_file, a_record);
+}
+
+// CSV column names
+void metrics_sink::write_csv_header(FILE * a_file)
+{
+    fputs("iteration,population,best,worst,mean,sigma,total_ns", a_file);
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p)
+        fprintf(a_file, ",%s_ns", generation_metrics::phase_name(static_cast<generation_phase>(p)));
+
+    fputs(",evaluations,children,mutations,allocations\n", a_file);
+}
+
+// CSV record
+void metrics_sink::write_csv(FILE * a_file, const metrics_record & a_record)
+{
+    fprintf(a_file, "%llu,%llu,%.17g,%.17g,%.17g,%.17g,%llu",
+            static_cast<unsigned long long>(a_record.iteration),
+            static_cast<unsigned long long>(a_record.population),
+            a_record.best_fitness,
+            a_record.worst_fitness,
+            a_record.mean_fitness,
+            a_record.sigma,
+            static_cast<unsigned long long>(a_record.total_ns));
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p)
+        fprintf(a_file, ",%llu", static_cast<unsigned long long>(a_record.phase_ns[p]));
+
+    fprintf(a_file, ",%llu,%llu,%llu,%llu\n",
+            static_cast<unsigned long long>(a_record.evaluations),
+            static_cast<unsigned long long>(a_record.children),
+            static_cast<unsigned long long>(a_record.mutations),
+            static_cast<unsigned long long>(a_record.allocations));
+}
+
+// check a binary header
+bool metrics_sink::read_header(FILE * a_file)
+{
+    metrics_file_header header;
+
+    if (fread(&header, sizeof(header), 1, a_file) != 1)
+        return false;
+
+    return (memcmp(header.magic, METRICS_MAGIC, sizeof(METRICS_MAGIC)) == 0)
+        && (header.version == VERSION)
+        && (header.record_size == sizeof(metrics_record))
+        && (header.phase_count == PHASE_COUNT);
+}
@@ -0,0 +1,346 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_METRICS_SINK_H)
+#define LIBEVOCOSM_METRICS_SINK_H
+
+// Standard C++ Library
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// libevocosm
+#include "listener.h"
+#include "metrics.h"
+#include "mpmc_queue.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! A fixed-layout summary of one generation
+    /*!
+        The unit of data written by a metrics_sink. Fitness statistics are
+        always present; timings and counts are zero unless the evocosm was
+        built with EVOCOSM_METRICS defined.
+    */
+    struct metrics_record
+    {
+        //! One-based generation number
+        uint64_t iteration;
+
+        //! Number of organisms
+        uint64_t population;
+
+        //! Highest fitness
+        double best_fitness;
+
+        //! Lowest fitness
+        double worst_fitness;
+
+        //! Mean fitness
+        double mean_fitness;
+
+        //! Standard deviation of fitness
+        double sigma;
+
+        //! Time for the whole generation, in nanoseconds
+        uint64_t total_ns;
+
+        //! Time spent in each phase, in nanoseconds
+        uint64_t phase_ns[PHASE_COUNT];
+
+        //! Number of fitness evaluations
+        uint64_t evaluations;
+
+        //! Number of children bred
+        uint64_t children;
+
+        //! Number of mutations applied
+        uint64_t mutations;
+
+        //! Number of heap allocations
+        uint64_t allocations;
+    };
+
+    //! Writes metrics records to a file on a background thread
+    /*!
+        The thread running evolution hands records to the sink through a
+        lock-free queue, and a writer thread formats and writes them, so
+        evolution never waits on I/O or text formatting. If the queue fills,
+        write waits for space rather than lose a record.
+        <p>
+        A binary file begins with an 8-byte magic string ("EVOMETRC"), then
+        32-bit version, record size, and phase count fields, followed by
+        records exactly as laid out in memory (native byte order). The
+        <i>metrics2csv</i> program converts such a file to CSV. A CSV file
+        has a header line followed by one line per record.
+        <p>
+        Programs using this class must be compiled and linked with thread
+        support (e.g., <i>-pthread</i>).
+    */
+    class metrics_sink
+    {
+    public:
+        //! File formats
+        enum file_format
+        {
+            FORMAT_BINARY,  //!< Fixed-size binary records
+            FORMAT_CSV      //!< Comma-separated text
+        };
+
+        //! Version number of the binary format
+        static const uint32_t VERSION = 1;
+
+        //! Creation constructor
+        /*!
+            Creates (or truncates) the output file and starts the writer
+            thread. Throws std::runtime_error if the file can't be opened.
+            \param a_filename - Name of the output file
+            \param a_format - Format of the output file
+            \param a_capacity - Records that can be queued before write waits
+        */
+        metrics_sink(const std::string & a_filename, file_format a_format = FORMAT_BINARY, size_t a_capacity = 4096);
+
+        //! Destructor
+        /*!
+            Writes any queued records, stops the writer thread, and closes
+            the file.
+        */
+        ~metrics_sink();
+
+        //! Queue a record for writing
+        /*!
+            Called by the thread running evolution; only one thread at a
+            time may call this function.
+            \param a_record - The record to be written
+        */
+        void write(const metrics_record & a_record);
+
+        //! Get the number of times write had to wait for queue space
+        size_t get_stalls() const
+        {
+            return m_stalls;
+        }
+
+        //! Write the CSV header line
+        /*!
+            \param a_file - Destination
+        */
+        static void write_csv_header(FILE * a_file);
+
+        //! Write a record as a line of CSV
+        /*!
+            \param a_file - Destination
+            \param a_record - The record to be written
+        */
+        static void write_csv(FILE * a_file, const metrics_record & a_record);
+
+        //! Read and check the header of a binary file
+        /*!
+            \param a_file - Source, positioned at the start of the file
+            \return <b>true</b> if the header is valid and matches this version of the library
+        */
+        static bool read_header(FILE * a_file);
+
+    private:
+        // not copyable
+        metrics_sink(const metrics_sink &);
+        metrics_sink & operator = (const metrics_sink &);
+
+        // body of the writer thread
+        void drain();
+
+        // write one record in the chosen format
+        void emit(const metrics_record & a_record);
+
+        // the output file
+        FILE * m_file;
+
+        // output format
+        file_format m_format;
+
+        // records waiting for the writer
+        mpmc_queue<metrics_record> m_queue;
+
+        // times write found the queue full
+        size_t m_stalls;
+
+        // tells the writer to finish
+        std::atomic<bool> m_stop;
+
+        // the writer
+        std::thread m_writer;
+    };
+
+    //! A listener that sends generation summaries to a metrics_sink
+    /*!
+        Computes fitness statistics in a single pass over the population --
+        without copying organisms -- and queues a record for each generation.
+        When EVOCOSM_METRICS is defined, the record waits for
+        ping_generation_metrics so that it includes timings.
+        \param OrganismType - The type of organism
+    */
+    template <typename OrganismType>
+    class sink_listener : public null_listener<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_sink - Destination for records; must outlive the listener
+        */
+        sink_listener(metrics_sink & a_sink)
+          : m_sink(a_sink),
+            m_record(),
+            m_pending(false)
+        {
+            // nada
+        }
+
+        //! Destructor
+        /*!
+            Sends any record still waiting for its metrics.
+        */
+        virtual ~sink_listener()
+        {
+            flush();
+        }
+
+        //! Ping that a generation begins
+        /*!
+            Sends the previous generation's record, if a stopped generation
+            left it waiting.
+            \param a_population Population before this generation's evolution
+            \param a_iteration One-based number of the generation begun
+        */
+        virtual void ping_generation_begin(const vector<OrganismType> & a_population, size_t a_iteration)
+        {
+            flush();
+        }
+
+        //! Ping that a generation ends
+        /*!
+            Summarizes the fitness of the tested population.
+            \param a_population Population for which processing has ended
+            \param a_iteration One-based number of the generation ended
+        */
+        virtual void ping_generation_end(const vector<OrganismType> & a_population, size_t a_iteration);
+
+        //! Report generation metrics
+        /*!
+            Adds timings and counts to the record, and sends it.
+            \param a_metrics Timings and counts for the generation
+        */
+        virtual void ping_generation_metrics(const generation_metrics & a_metrics);
+
+        //! Send a waiting record
+        void flush()
+        {
+            if (m_pending)
+            {
+                m_sink.write(m_record);
+                m_pending = false;
+            }
+        }
+
+    private:
+        // where records go
+        metrics_sink & m_sink;
+
+        // the record being built
+        metrics_record m_record;
+
+        // is m_record waiting to be sent?
+        bool m_pending;
+    };
+
+    // summarize a generation
+    template <typename OrganismType>
+    void sink_listener<OrganismType>::ping_generation_end(const vector<OrganismType> & a_population, size_t a_iteration)
+    {
+        flush();
+
+        metrics_record & r = m_record;
+        r = metrics_record();
+        r.iteration  = a_iteration;
+        r.population = a_population.size();
+
+        if (!a_population.empty())
+        {
+            double best  = a_population[0].fitness;
+            double worst = best;
+            double total = 0.0;
+
+            for (size_t n = 0; n < a_population.size(); ++n)
+            {
+                double f = a_population[n].fitness;
+
+                if (f > best)
+                    best = f;
+
+                if (f < worst)
+                    worst = f;
+
+                total += f;
+            }
+
+            double mean = total / static_cast<double>(a_population.size());
+            double var  = 0.0;
+
+            for (size_t n = 0; n < a_population.size(); ++n)
+            {
+                double d = a_population[n].fitness - mean;
+                var += d * d;
+            }
+
+            r.best_fitness  = best;
+            r.worst_fitness = worst;
+            r.mean_fitness  = mean;
+            r.sigma         = sqrt(var / static_cast<double>(a_population.size()));
+        }
+
+        m_pending = true;
+
+#if !defined(EVOCOSM_METRICS)
+        flush();
+#endif
+    }
+
+    // add timings to a summary
+    template <typename OrganismType>
+    void sink_listener<OrganismType>::ping_generation_metrics(const generation_metrics & a_metrics)
+    {
+        if (!m_pending)
+            return;
+
+        m_record.total_ns = a_metrics.total_ns;
+
+        for (size_t p = 0; p < PHASE_COUNT; ++p)
+            m_record.phase_ns[p] = a_metrics.phase_ns[p];
+
+        m_record.evaluations = a_metrics.evaluations;
+        m_record.children    = a_metrics.children;
+        m_record.mutations   = a_metrics.mutations;
+        m_record.allocations = a_metrics.allocations;
+
+        flush();
+    }
+};
+
+#endif
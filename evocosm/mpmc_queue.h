@@ -0,0 +1,177 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_MPMC_QUEUE_H)
+#define LIBEVOCOSM_MPMC_QUEUE_H
+
+// Standard C++ Library
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace libevocosm
+{
+    //! A bounded, lock-free, multi-producer multi-consumer queue
+    /*!
+        Dmitry Vyukov's bounded MPMC queue: a ring of cells, each with a
+        sequence number that tells producers and consumers whether the cell
+        is ready for them. Pushing and popping cost one compare-and-swap in
+        the uncontended case, and neither ever blocks; a full or empty queue
+        simply reports failure.
+        <p>
+        Capacity is rounded up to a power of two.
+        \param Type - The type of element; must be default-constructible and copyable
+    */
+    template <typename Type>
+    class mpmc_queue
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_capacity - Minimum number of elements the queue can hold
+        */
+        mpmc_queue(size_t a_capacity)
+          : m_cells(round_up(a_capacity)),
+            m_mask(round_up(a_capacity) - 1),
+            m_head(0),
+            m_tail(0)
+        {
+            for (size_t n = 0; n < m_cells.size(); ++n)
+                m_cells[n].m_sequence.store(n, std::memory_order_relaxed);
+        }
+
+        //! Get capacity
+        size_t capacity() const
+        {
+            return m_cells.size();
+        }
+
+        //! Add an element
+        /*!
+            \param a_value - Value to be added
+            \return <b>false</b> if the queue is full
+        */
+        bool try_push(const Type & a_value)
+        {
+            size_t pos = m_tail.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                cell & c = m_cells[pos & m_mask];
+                size_t seq = c.m_sequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        c.m_value = a_value;
+                        c.m_sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        //! Remove an element
+        /*!
+            \param a_value - Receives the value removed
+            \return <b>false</b> if the queue is empty
+        */
+        bool try_pop(Type & a_value)
+        {
+            size_t pos = m_head.load(std::memory_order_relaxed);
+
+            for (;;)
+            {
+                cell & c = m_cells[pos & m_mask];
+                size_t seq = c.m_sequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        a_value = c.m_value;
+                        c.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        // not copyable
+        mpmc_queue(const mpmc_queue &);
+        mpmc_queue & operator = (const mpmc_queue &);
+
+        // smallest power of two >= a_n (and >= 2)
+        static size_t round_up(size_t a_n)
+        {
+            size_t result = 2;
+
+            while (result < a_n)
+                result <<= 1;
+
+            return result;
+        }
+
+        // a slot in the ring
+        struct cell
+        {
+            std::atomic<size_t> m_sequence;
+            Type m_value;
+
+            cell()
+              : m_sequence(0),
+                m_value()
+            {
+                // nada
+            }
+
+            // vector requires these, but cells are only copied while empty
+            cell(const cell & a_source)
+              : m_sequence(a_source.m_sequence.load(std::memory_order_relaxed)),
+                m_value(a_source.m_value)
+            {
+                // nada
+            }
+        };
+
+        // the ring
+        std::vector<cell> m_cells;
+
+        // index mask
+        const size_t m_mask;
+
+        // keep producers and consumers on separate cache lines; padded, since
+        // queues are allocated on the heap, where alignas can't be relied on
+        char m_pad1[64];
+        std::atomic<size_t> m_head;
+        char m_pad2[64];
+        std::atomic<size_t> m_tail;
+        char m_pad3[64];
+    };
+};
+
+#endif
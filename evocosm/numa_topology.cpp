@@ -0,0 +1,186 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(EVOCOSM_LIBNUMA)
+#include <numa.h>
+#endif
+
+#include "numa_topology.h"
+using namespace libevocosm;
+
+#if defined(__linux__) && !defined(EVOCOSM_LIBNUMA)
+// parse a kernel CPU list, such as "0-3,8-11"
+static vector<size_t> parse_cpu_list(const std::string & a_text)
+{
+    vector<size_t> result;
+    const char * p = a_text.c_str();
+
+    while (*p != '\0')
+    {
+        char * end = NULL;
+        unsigned long first = strtoul(p, &end, 10);
+
+        if (end == p)
+            break;
+
+        unsigned long last = first;
+        p = end;
+
+        if (*p == '-')
+        {
+            last = strtoul(p + 1, &end, 10);
+            p = end;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; ++cpu)
+            result.push_back(static_cast<size_t>(cpu));
+
+        while ((*p == ',') || (*p == '\n') || (*p == ' '))
+            ++p;
+    }
+
+    return result;
+}
+#endif
+
+// detect nodes
+numa_topology::numa_topology()
+  : m_cpus(),
+    m_ids()
+{
+#if defined(EVOCOSM_LIBNUMA)
+    if (numa_available() >= 0)
+    {
+        struct bitmask * mask = numa_allocate_cpumask();
+
+        for (int node = 0; node <= numa_max_node(); ++node)
+        {
+            // nodes without CPUs (memory-only) run no threads
+            if (numa_node_to_cpus(node, mask) != 0)
+                continue;
+
+            vector<size_t> cpus;
+
+            for (unsigned int cpu = 0; cpu < mask->size; ++cpu)
+            {
+                if (numa_bitmask_isbitset(mask, cpu))
+                    cpus.push_back(cpu);
+            }
+
+            if (!cpus.empty())
+            {
+                m_cpus.push_back(cpus);
+                m_ids.push_back(node);
+            }
+        }
+
+        numa_free_cpumask(mask);
+    }
+#elif defined(__linux__)
+    for (int node = 0; node < 1024; ++node)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "/sys/devices/system/node/node%d/cpulist", node);
+
+        FILE * file = fopen(name, "r");
+
+        if (file == NULL)
+        {
+            // node numbers may have gaps, but not many
+            if (node >= 64)
+                break;
+
+            continue;
+        }
+
+        char text[4096];
+        std::string list;
+
+        if (fgets(text, sizeof(text), file) != NULL)
+            list = text;
+
+        fclose(file);
+
+        vector<size_t> cpus = parse_cpu_list(list);
+
+        if (!cpus.empty())
+        {
+            m_cpus.push_back(cpus);
+            m_ids.push_back(node);
+        }
+    }
+#endif
+
+    // one node with every CPU
+    if (m_cpus.empty())
+    {
+        vector<size_t> cpus;
+
+        for (unsigned int cpu = 0; cpu < std::thread::hardware_concurrency(); ++cpu)
+            cpus.push_back(cpu);
+
+        m_cpus.clear();
+        m_ids.clear();
+        m_cpus.push_back(cpus);
+        m_ids.push_back(0);
+    }
+}
+
+// the host's topology
+const numa_topology & numa_topology::host()
+{
+    static const numa_topology topology;
+    return topology;
+}
+
+// bind the calling thread
+bool numa_topology::bind_thread(size_t a_node) const
+{
+    if ((a_node >= m_cpus.size()) || !is_numa())
+        return false;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+
+    for (size_t n = 0; n < m_cpus[a_node].size(); ++n)
+    {
+        if (m_cpus[a_node][n] < CPU_SETSIZE)
+            CPU_SET(m_cpus[a_node][n], &set);
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        return false;
+
+#if defined(EVOCOSM_LIBNUMA)
+    // allocate on the node even when the first touch comes later, from elsewhere
+    numa_set_preferred(m_ids[a_node]);
+#endif
+
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,104 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_NUMA_TOPOLOGY_H)
+#define LIBEVOCOSM_NUMA_TOPOLOGY_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <vector>
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! The NUMA nodes of the host, and the CPUs in each
+    /*!
+        On a multi-socket host, memory is attached to a node, and a thread
+        reaches memory on its own node faster than memory on another. Linux
+        places a page on the node of the thread that first touches it, so a
+        thread bound to a node and building its own data keeps that data
+        local.
+        <p>
+        The topology comes from libnuma when the library was configured
+        with it, and otherwise from /sys/devices/system/node. Elsewhere, or
+        on a host with one node, it is a single node holding every CPU, and
+        binding does nothing.
+    */
+    class numa_topology
+    {
+    public:
+        //! Get the host's topology
+        /*!
+            Detected once, on first use.
+            \return The topology of this host
+        */
+        static const numa_topology & host();
+
+        //! Get the number of nodes
+        size_t node_count() const
+        {
+            return m_cpus.size();
+        }
+
+        //! Is there more than one node?
+        bool is_numa() const
+        {
+            return m_cpus.size() > 1;
+        }
+
+        //! Get the system's number for a node
+        /*!
+            Nodes without CPUs are left out, so indexes and numbers may differ.
+            \param a_node - Index of the node
+        */
+        int get_id(size_t a_node) const
+        {
+            return m_ids[a_node];
+        }
+
+        //! Get the CPUs of a node
+        /*!
+            \param a_node - Index of the node
+            \return Numbers of its CPUs; empty if they are not known
+        */
+        const vector<size_t> & get_cpus(size_t a_node) const
+        {
+            return m_cpus[a_node];
+        }
+
+        //! Bind the calling thread to a node
+        /*!
+            Restricts the thread to the node's CPUs, so the memory it touches
+            first is placed on that node; with libnuma, the thread also
+            prefers that node for its allocations.
+            \param a_node - Index of the node
+            \return <b>false</b> if the thread could not be bound
+        */
+        bool bind_thread(size_t a_node) const;
+
+    private:
+        // detect the topology
+        numa_topology();
+
+        // CPUs of each node
+        vector< vector<size_t> > m_cpus;
+
+        // the system's number for each node
+        vector<int> m_ids;
+    };
+};
+
+#endif
@@ -156,6 +156,57 @@ namespace libevocosm
         }
     };
 
+    //! An organism without virtual members
+    /*!
+        The same fitness and genes as organism, with no vtable: it is
+        trivially copyable whenever its genotype is (e.g., a std::array of
+        doubles), so a population can be copied as a block of memory, and
+        comparisons and resets inline. Meant for static_evocosm, but works
+        with any component that uses only fitness, genes, the value
+        constructor and operator <.
+        \param Genotype - The type of genes for this organism class
+    */
+    template <typename Genotype>
+    struct static_organism
+    {
+        //! Fitness assigned by testing, and perhaps changed by scaling
+        double fitness;
+
+        //! The genes that define the organism's behavior
+        Genotype genes;
+
+        //! Creation constructor
+        static_organism()
+            : fitness(0.0),
+              genes()
+        {
+            // nada
+        }
+
+        //! Value constructor
+        /*!
+            \param a_genes - Gene value for the new organism
+        */
+        static_organism(const Genotype & a_genes)
+            : fitness(0.0),
+              genes(a_genes)
+        {
+            // nada
+        }
+
+        //! Comparison operator for algorithms; fitter organisms sort first
+        bool operator < (const static_organism & a_right) const
+        {
+            return (fitness > a_right.fitness);
+        }
+
+        //! Resets an object to it's initial state
+        void reset()
+        {
+            fitness = 0.0;
+        }
+    };
+
 };
 
 #endif
@@ -0,0 +1,755 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_PRNG_H)
+#define LIBEVOCOSM_PRNG_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <type_traits>
+#include <utility>
+
+namespace libevocosm
+{
+    //! Next value of a SplitMix64 sequence
+    /*!
+        Used to expand a single seed into the full state of an engine, so
+        that every bit of the state depends on every bit of the seed.
+        \param a_state - Sequence state; advanced by each call
+        \return A well-mixed 64-bit value
+    */
+    inline unsigned long long int splitmix64(unsigned long long int & a_state)
+    {
+        unsigned long long int z = (a_state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    //! Marsaglia's 64-bit "Keep It Simple Stupid" generator
+    /*!
+        The original Evocosm generator, from the following thread:
+            http://www.thecodingforums.com/threads/64-bit-kiss-rngs.673657/
+        Retained for comparison with earlier results; xoshiro256_engine is
+        faster and statistically stronger.
+    */
+    class kiss_engine
+    {
+    public:
+        //! Number of words in the engine's state
+        static const size_t STATE_WORDS = 4;
+
+        //! Identifies the engine in checkpoint files
+        static const uint32_t ID = 1;
+
+        //! Seed the engine
+        void seed(unsigned long long int a_seed)
+        {
+            x = splitmix64(a_seed);
+            c = splitmix64(a_seed) >> 6;
+            y = splitmix64(a_seed);
+            z = splitmix64(a_seed);
+
+            // the xorshift component must not be zero
+            if (y == 0)
+                y = 362436362436362436ULL;
+        }
+
+        //! Get the next 64 bits
+        unsigned long long int next()
+        {
+            unsigned long long int t = (x << 58) + c;
+            c  = x >> 6;
+            x += t;
+            c += (x < t);
+
+            y ^= (y << 13);
+            y ^= (y >> 17);
+            y ^= (y << 43);
+
+            z = 6906969069ULL * z + 1234567ULL;
+
+            return x + y + z;
+        }
+
+        //! Get the engine's state
+        void get_state(unsigned long long int * a_state) const
+        {
+            a_state[0] = x;
+            a_state[1] = c;
+            a_state[2] = y;
+            a_state[3] = z;
+        }
+
+        //! Set the engine's state
+        void set_state(const unsigned long long int * a_state)
+        {
+            x = a_state[0];
+            c = a_state[1];
+            y = a_state[2];
+            z = a_state[3];
+        }
+
+    private:
+        unsigned long long int x = 1234567890987654321ULL;
+        unsigned long long int c =  123456123456123456ULL;
+        unsigned long long int y =  362436362436362436ULL;
+        unsigned long long int z =    1066149217761810ULL;
+    };
+
+    //! Blackman and Vigna's xoshiro256** generator
+    /*!
+        A small, very fast generator that passes all known statistical
+        tests; the default engine.
+    */
+    class xoshiro256_engine
+    {
+    public:
+        //! Number of words in the engine's state
+        static const size_t STATE_WORDS = 4;
+
+        //! Identifies the engine in checkpoint files
+        static const uint32_t ID = 2;
+
+        //! Seed the engine
+        void seed(unsigned long long int a_seed)
+        {
+            for (size_t n = 0; n < 4; ++n)
+                s[n] = splitmix64(a_seed);
+
+            // an all-zero state would produce only zeros
+            if ((s[0] | s[1] | s[2] | s[3]) == 0)
+                s[0] = 0x9E3779B97F4A7C15ULL;
+        }
+
+        //! Get the next 64 bits
+        unsigned long long int next()
+        {
+            unsigned long long int result = rotl(s[1] * 5, 7) * 9;
+            unsigned long long int t = s[1] << 17;
+
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3]  = rotl(s[3], 45);
+
+            return result;
+        }
+
+        //! Get the engine's state
+        void get_state(unsigned long long int * a_state) const
+        {
+            for (size_t n = 0; n < 4; ++n)
+                a_state[n] = s[n];
+        }
+
+        //! Set the engine's state
+        void set_state(const unsigned long long int * a_state)
+        {
+            for (size_t n = 0; n < 4; ++n)
+                s[n] = a_state[n];
+        }
+
+    private:
+        static unsigned long long int rotl(unsigned long long int a_x, int a_k)
+        {
+            return (a_x << a_k) | (a_x >> (64 - a_k));
+        }
+
+        unsigned long long int s[4] = { 0x9E3779B97F4A7C15ULL, 0xBF58476D1CE4E5B9ULL, 0x94D049BB133111EBULL, 1ULL };
+    };
+
+#if defined(__SIZEOF_INT128__)
+    //! O'Neill's PCG64 (XSL-RR 128/64) generator
+    /*!
+        A 128-bit linear congruential generator with a permuted output;
+        requires a compiler with 128-bit integers.
+    */
+    class pcg64_engine
+    {
+    public:
+        //! Number of words in the engine's state
+        static const size_t STATE_WORDS = 4;
+
+        //! Identifies the engine in checkpoint files
+        static const uint32_t ID = 3;
+
+        //! Seed the engine
+        void seed(unsigned long long int a_seed)
+        {
+            unsigned long long int hi = splitmix64(a_seed);
+            unsigned long long int lo = splitmix64(a_seed);
+            m_inc = ((static_cast<unsigned __int128>(splitmix64(a_seed)) << 64) | splitmix64(a_seed)) | 1;
+            m_state = 0;
+            next();
+            m_state += (static_cast<unsigned __int128>(hi) << 64) | lo;
+            next();
+        }
+
+        //! Get the next 64 bits
+        unsigned long long int next()
+        {
+            static const unsigned __int128 MULTIPLIER = (static_cast<unsigned __int128>(0x2360ED051FC65DA4ULL) << 64) | 0x4385DF649FCCF645ULL;
+
+            m_state = m_state * MULTIPLIER + m_inc;
+
+            unsigned long long int x = static_cast<unsigned long long int>(m_state >> 64) ^ static_cast<unsigned long long int>(m_state);
+            unsigned int rot = static_cast<unsigned int>(m_state >> 122);
+
+            return (x >> rot) | (x << ((64 - rot) & 63));
+        }
+
+        //! Get the engine's state
+        void get_state(unsigned long long int * a_state) const
+        {
+            a_state[0] = static_cast<unsigned long long int>(m_state >> 64);
+            a_state[1] = static_cast<unsigned long long int>(m_state);
+            a_state[2] = static_cast<unsigned long long int>(m_inc >> 64);
+            a_state[3] = static_cast<unsigned long long int>(m_inc);
+        }
+
+        //! Set the engine's state
+        void set_state(const unsigned long long int * a_state)
+        {
+            m_state = (static_cast<unsigned __int128>(a_state[0]) << 64) | a_state[1];
+            m_inc   = (static_cast<unsigned __int128>(a_state[2]) << 64) | a_state[3];
+        }
+
+    private:
+        unsigned __int128 m_state = 0x4D595DF4D0F33173ULL;
+        unsigned __int128 m_inc   = 0xDA3E39CB94B95BDBULL;
+    };
+#endif
+
+    //! Salmon et al.'s Philox4x32-10 counter-based generator
+    /*!
+        Each 128-bit output block is a pure function of a 128-bit counter
+        and a 64-bit key, so blocks can be computed in any order, or in
+        parallel; as an engine, it simply counts upward. The block function
+        is public for callers that want random values keyed by position
+        rather than drawn in sequence.
+    */
+    class philox_engine
+    {
+    public:
+        //! Number of words in the engine's state
+        static const size_t STATE_WORDS = 6;
+
+        //! Identifies the engine in checkpoint files
+        static const uint32_t ID = 4;
+
+        //! Compute one block
+        /*!
+            \param a_counter_lo - Low 64 bits of the counter
+            \param a_counter_hi - High 64 bits of the counter
+            \param a_key - The key
+            \param a_out - Receives 128 random bits
+        */
+        static void block(unsigned long long int a_counter_lo,
+                          unsigned long long int a_counter_hi,
+                          unsigned long long int a_key,
+                          unsigned long long int a_out[2])
+        {
+            uint32_t c0 = static_cast<uint32_t>(a_counter_lo);
+            uint32_t c1 = static_cast<uint32_t>(a_counter_lo >> 32);
+            uint32_t c2 = static_cast<uint32_t>(a_counter_hi);
+            uint32_t c3 = static_cast<uint32_t>(a_counter_hi >> 32);
+            uint32_t k0 = static_cast<uint32_t>(a_key);
+            uint32_t k1 = static_cast<uint32_t>(a_key >> 32);
+
+            for (int round = 0; round < 10; ++round)
+            {
+                uint64_t p0 = static_cast<uint64_t>(0xD2511F53U) * c0;
+                uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57U) * c2;
+
+                uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+
+                c0 = n0;
+                c1 = static_cast<uint32_t>(p1);
+                c2 = n2;
+                c3 = static_cast<uint32_t>(p0);
+
+                k0 += 0x9E3779B9U;
+                k1 += 0xBB67AE85U;
+            }
+
+            a_out[0] = (static_cast<unsigned long long int>(c1) << 32) | c0;
+            a_out[1] = (static_cast<unsigned long long int>(c3) << 32) | c2;
+        }
+
+        //! Seed the engine
+        void seed(unsigned long long int a_seed)
+        {
+            m_key = splitmix64(a_seed);
+            m_counter_lo = 0;
+            m_counter_hi = splitmix64(a_seed);
+            m_index = 2;
+        }
+
+        //! Get the next 64 bits
+        unsigned long long int next()
+        {
+            if (m_index == 2)
+            {
+                block(m_counter_lo, m_counter_hi, m_key, m_buffer);
+
+                if (++m_counter_lo == 0)
+                    ++m_counter_hi;
+
+                m_index = 0;
+            }
+
+            return m_buffer[m_index++];
+        }
+
+        //! Fill an array with random bits
+        /*!
+            Whole blocks are independent of each other, so this loop can
+            be vectorized.
+            \param a_out - Destination
+            \param a_count - Number of values
+        */
+        void fill(unsigned long long int * a_out, size_t a_count)
+        {
+            size_t n = 0;
+
+            while ((m_index < 2) && (n < a_count))
+                a_out[n++] = m_buffer[m_index++];
+
+            size_t blocks = (a_count - n) / 2;
+
+            for (size_t b = 0; b < blocks; ++b)
+            {
+                unsigned long long int counter = m_counter_lo + b;
+                block(counter, m_counter_hi + (counter < m_counter_lo ? 1 : 0), m_key, a_out + n + 2 * b);
+            }
+
+            unsigned long long int old_lo = m_counter_lo;
+            m_counter_lo += blocks;
+
+            if (m_counter_lo < old_lo)
+                ++m_counter_hi;
+
+            for (n += 2 * blocks; n < a_count; ++n)
+                a_out[n] = next();
+        }
+
+        //! Get the engine's state
+        void get_state(unsigned long long int * a_state) const
+        {
+            a_state[0] = m_counter_lo;
+            a_state[1] = m_counter_hi;
+            a_state[2] = m_key;
+            a_state[3] = m_buffer[0];
+            a_state[4] = m_buffer[1];
+            a_state[5] = m_index;
+        }
+
+        //! Set the engine's state
+        void set_state(const unsigned long long int * a_state)
+        {
+            m_counter_lo = a_state[0];
+            m_counter_hi = a_state[1];
+            m_key        = a_state[2];
+            m_buffer[0]  = a_state[3];
+            m_buffer[1]  = a_state[4];
+            m_index      = (a_state[5] < 2) ? static_cast<size_t>(a_state[5]) : 2;
+        }
+
+    private:
+        unsigned long long int m_counter_lo = 0;
+        unsigned long long int m_counter_hi = 0;
+        unsigned long long int m_key = 0x9E3779B97F4A7C15ULL;
+        unsigned long long int m_buffer[2] = { 0, 0 };
+        size_t m_index = 2;
+    };
+
+    //! What a keyed random stream is used for
+    /*!
+        Operators that draw for the same organism in the same generation
+        use different streams, so their values are independent.
+    */
+    enum stream_purpose
+    {
+        STREAM_GENERAL = 0,
+        STREAM_BREED,
+        STREAM_MUTATE,
+        STREAM_SELECT
+    };
+
+    //! Does an engine have a fill of its own?
+    template <class Engine>
+    struct engine_fills
+    {
+    private:
+        template <class E>
+        static auto test(int) -> decltype(std::declval<E &>().fill(static_cast<unsigned long long int *>(nullptr), size_t(0)), std::true_type());
+
+        template <class E>
+        static std::false_type test(long);
+
+    public:
+        //! <b>true</b> if Engine has fill
+        static const bool value = decltype(test<Engine>(0))::value;
+    };
+
+    //! A random number generator built on an engine
+    /*!
+        The engine supplies raw 64-bit values; this class seeds it and
+        turns its output into the values Evocosm uses. Every engine is
+        seeded through SplitMix64, so its whole state depends on the seed.
+        Bounded integers use Lemire's nearly-divisionless method, which
+        is unbiased; reals take the top 53 bits of a value, so every one
+        of the 2^53 evenly-spaced doubles in [0,1) is equally likely.
+        <p>
+        set_stream moves the generator to a stream keyed by position: the
+        engine is reseeded from a Philox4x32-10 block of (generation,
+        organism, purpose) under a key made from the seed, so every value
+        drawn afterward is a pure function of the seed, the position, and
+        how many values came before it in that stream. Code that positions
+        the stream for each organism gets the same results whatever order,
+        or thread, the organisms are handled in, and after a restart.
+        <p>
+        An engine with a fill of its own (Philox, whose blocks are
+        independent, so its fill vectorizes) is buffered: values are drawn
+        from it a block at a time, into a buffer of bits and the reals made
+        from them, and handed out from there, which amortizes the engine's
+        overhead across the block. Engines without fill produce each value
+        from the last, so a block costs as much as the values one at a
+        time; they are drawn from directly. The first block after any reseeding
+        holds only MIN_BLOCK values, and each block after it is twice the
+        size of the last, up to BUFFER_WORDS; a stream that is reseeded for
+        every organism thus fills little it does not use. Buffering does
+        not change the sequence: the values are the ones the engine would
+        have given one at a time, and get_state records where the current
+        block began and how much of it was used, so a restored generator
+        continues exactly.
+        <p>
+        An engine provides STATE_WORDS, ID (a number no other engine uses),
+        seed, next, get_state and set_state; it may also provide fill, to
+        produce many values at once faster than one at a time.
+        \param Engine - The source of raw random bits
+    */
+    template <class Engine>
+    class basic_prng
+    {
+    public:
+        //! The engine type
+        typedef Engine engine_type;
+
+        //! Number of words in the generator's state
+        static const size_t STATE_WORDS = Engine::STATE_WORDS + 5;
+
+        //! Is the engine's output buffered?
+        static const bool BUFFERED = engine_fills<Engine>::value;
+
+        //! Most values drawn from the engine at once (2 KB of bits)
+        static const size_t BUFFER_WORDS = BUFFERED ? 256 : 1;
+
+        //! Values drawn from the engine at once after reseeding
+        static const size_t MIN_BLOCK = 8;
+
+        //! Constructor
+        basic_prng(const unsigned long long seed = (unsigned long long int)(time(nullptr)))
+        {
+            set_seed(seed);
+        }
+
+        //! Seed the generator
+        void set_seed(unsigned long long int seed = (unsigned long long int)(time(nullptr)))
+        {
+            m_seed = seed;
+            m_generation = 0;
+            m_purpose = STREAM_GENERAL;
+            reseed(seed);
+        }
+
+        //! Move to the start of a keyed stream
+        /*!
+            Does not change the seed; streams with the same position but
+            different seeds are independent.
+            \param a_generation - Generation, or any other 56-bit sequence number
+            \param a_organism - Index of the organism the values are for
+            \param a_purpose - What the values are used for
+        */
+        void set_stream(unsigned long long int a_generation, unsigned long long int a_organism, stream_purpose a_purpose = STREAM_GENERAL)
+        {
+            m_generation = a_generation;
+            m_purpose = a_purpose;
+            set_organism(a_organism);
+        }
+
+        //! Move to the stream of another organism
+        /*!
+            Keeps the generation and purpose of the last set_stream, so an
+            operator can key its draws per organism without knowing the
+            generation. It replaces the organism given to set_stream, so a
+            caller that numbers something else (such as steady-state births)
+            must put that number in the generation.
+            \param a_organism - Index of the organism the values are for
+        */
+        void set_organism(unsigned long long int a_organism)
+        {
+            unsigned long long int key = m_seed;
+            unsigned long long int block[2];
+
+            philox_engine::block(a_organism, (m_generation << 8) | (m_purpose & 0xFF), splitmix64(key), block);
+            reseed(block[0]);
+        }
+
+        //! Get the last seed
+        unsigned long long int get_seed()
+        {
+            return m_seed;
+        }
+
+        //! Get the generator's state
+        /*!
+            Captures the complete state, so that a restored generator
+            continues with exactly the same sequence.
+            \param a_state - Receives STATE_WORDS values
+        */
+        void get_state(unsigned long long int * a_state) const
+        {
+            // a partly used block is recorded as the engine state it was filled from
+            if (m_next < m_block)
+            {
+                for (size_t n = 0; n < Engine::STATE_WORDS; ++n)
+                    a_state[n] = m_block_start[n];
+            }
+            else
+                m_engine.get_state(a_state);
+
+            a_state[Engine::STATE_WORDS]     = m_seed;
+            a_state[Engine::STATE_WORDS + 1] = m_generation;
+            a_state[Engine::STATE_WORDS + 2] = m_purpose;
+            a_state[Engine::STATE_WORDS + 3] = m_block;
+            a_state[Engine::STATE_WORDS + 4] = m_next;
+        }
+
+        //! Set the generator's state
+        /*!
+            \param a_state - STATE_WORDS values from get_state
+        */
+        void set_state(const unsigned long long int * a_state)
+        {
+            m_engine.set_state(a_state);
+            m_seed       = a_state[Engine::STATE_WORDS];
+            m_generation = a_state[Engine::STATE_WORDS + 1];
+            m_purpose    = a_state[Engine::STATE_WORDS + 2];
+
+            size_t block = static_cast<size_t>(a_state[Engine::STATE_WORDS + 3]);
+            size_t next  = static_cast<size_t>(a_state[Engine::STATE_WORDS + 4]);
+
+            if ((block < MIN_BLOCK) || (block > BUFFER_WORDS))
+                block = 0;
+
+            // refill the block that was in use, and skip what had been taken from it
+            if (next < block)
+            {
+                fill_block(block);
+                m_next = next;
+            }
+            else
+            {
+                m_block = block;
+                m_next  = block;
+            }
+        }
+
+        //! get the next 64 random bits
+        unsigned long long int next()
+        {
+            if (!BUFFERED)
+                return m_engine.next();
+
+            if (m_next == m_block)
+                refill();
+
+            return m_bits[m_next++];
+        }
+
+        //! get a random index value in [0,n)
+        size_t get_index(size_t n)
+        {
+            unsigned long long int bound = static_cast<unsigned long long int>(n);
+
+#if defined(__SIZEOF_INT128__)
+            // Lemire's method; divides only when a value falls in the biased region
+            unsigned __int128 m = static_cast<unsigned __int128>(next()) * bound;
+            unsigned long long int low = static_cast<unsigned long long int>(m);
+
+            if (low < bound)
+            {
+                unsigned long long int threshold = (0ULL - bound) % bound;
+
+                while (low < threshold)
+                {
+                    m = static_cast<unsigned __int128>(next()) * bound;
+                    low = static_cast<unsigned long long int>(m);
+                }
+            }
+
+            return static_cast<size_t>(m >> 64);
+#else
+            // reject the values that would make a remainder biased
+            unsigned long long int threshold = (0ULL - bound) % bound;
+            unsigned long long int x = next();
+
+            while (x < threshold)
+                x = next();
+
+            return static_cast<size_t>(x % bound);
+#endif
+        }
+
+        //! get the next value in the range [0,1)
+        double get_real()
+        {
+            if (!BUFFERED)
+                return to_real(m_engine.next());
+
+            if (m_next == m_block)
+                refill();
+
+            return m_reals[m_next++];
+        }
+
+        //! Fill an array with random bits
+        /*!
+            Takes what is left of the buffer first, then draws the rest
+            from the engine directly.
+            \param a_out - Destination
+            \param a_count - Number of values
+        */
+        void fill(unsigned long long int * a_out, size_t a_count)
+        {
+            size_t n = 0;
+
+            while ((m_next < m_block) && (n < a_count))
+                a_out[n++] = m_bits[m_next++];
+
+            fill_bits(m_engine, a_out + n, a_count - n, 0);
+        }
+
+        //! Fill an array with values in the range [0,1)
+        /*!
+            Gives the same values as calling get_real for each element;
+            bits are drawn a block at a time and converted in a separate
+            loop the compiler can vectorize.
+            \param a_out - Destination
+            \param a_count - Number of values
+        */
+        void fill(double * a_out, size_t a_count)
+        {
+            static const size_t BLOCK = 64;
+            unsigned long long int bits[BLOCK];
+
+            for (size_t n = 0; n < a_count; n += BLOCK)
+            {
+                size_t count = (a_count - n < BLOCK) ? (a_count - n) : BLOCK;
+                fill(bits, count);
+
+                for (size_t i = 0; i < count; ++i)
+                    a_out[n + i] = to_real(bits[i]);
+            }
+        }
+
+        //! Convert 64 random bits to a value in the range [0,1)
+        static double to_real(unsigned long long int a_bits)
+        {
+            // 53 bits fit a signed conversion, which (unlike an unsigned one) is a single instruction
+            return static_cast<double>(static_cast<long long int>(a_bits >> 11)) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        // start over from a new engine seed, discarding the buffer
+        void reseed(unsigned long long int a_seed)
+        {
+            m_engine.seed(a_seed);
+            m_block = 0;
+            m_next  = 0;
+        }
+
+        // draw the next block from the engine
+        void refill()
+        {
+            if (m_block == 0)
+                fill_block(MIN_BLOCK);
+            else
+                fill_block((m_block < BUFFER_WORDS / 2) ? (m_block * 2) : BUFFER_WORDS);
+        }
+
+        // draw a block of the given size from the engine
+        void fill_block(size_t a_size)
+        {
+            m_engine.get_state(m_block_start);
+
+            // a local engine, whose state the compiler can keep in registers
+            // instead of assuming every store to the buffer changes it
+            Engine engine = m_engine;
+            fill_bits(engine, m_bits, a_size, 0);
+            m_engine = engine;
+
+            for (size_t n = 0; n < a_size; ++n)
+                m_reals[n] = to_real(m_bits[n]);
+
+            m_block = a_size;
+            m_next  = 0;
+        }
+
+        // engines with a fill of their own use it
+        template <class E>
+        static auto fill_bits(E & a_engine, unsigned long long int * a_out, size_t a_count, int) -> decltype(a_engine.fill(a_out, a_count))
+        {
+            return a_engine.fill(a_out, a_count);
+        }
+
+        template <class E>
+        static void fill_bits(E & a_engine, unsigned long long int * a_out, size_t a_count, long)
+        {
+            for (size_t n = 0; n < a_count; ++n)
+                a_out[n] = a_engine.next();
+        }
+
+        // the source of bits
+        Engine m_engine;
+
+        // last seed
+        unsigned long long int m_seed;
+
+        // position of the current keyed stream
+        unsigned long long int m_generation;
+        unsigned long long int m_purpose;
+
+        // values drawn from the engine, as bits and as reals; m_block is
+        // the size of the current block (zero after reseeding), and m_next
+        // the next unused value in it
+        unsigned long long int m_bits[BUFFER_WORDS];
+        double m_reals[BUFFER_WORDS];
+        size_t m_block;
+        size_t m_next;
+
+        // engine state the current block was filled from
+        unsigned long long int m_block_start[Engine::STATE_WORDS];
+    };
+};
+
+#endif
@@ -92,6 +92,42 @@ roulette_wheel::roulette_wheel(const roulette_wheel & a_source)
     memcpy(m_weights,a_source.m_weights,sizeof(double) * m_size);
 }
 
+// restoring constructor
+roulette_wheel::roulette_wheel(checkpoint_reader & a_in)
+  : m_size(a_in.get_size()),
+    m_weights(NULL),
+    m_total_weight(0.0),
+    m_min_weight(0.0),
+    m_max_weight(0.0)
+{
+    validate_not(m_size,size_t(0),"Roulette wheel can not have zero size");
+
+    m_weights = new double[m_size];
+
+    try
+    {
+        a_in.get_bytes(m_weights,sizeof(double) * m_size);
+        m_total_weight = a_in.get<double>();
+        m_min_weight   = a_in.get<double>();
+        m_max_weight   = a_in.get<double>();
+    }
+    catch (...)
+    {
+        delete [] m_weights;
+        throw;
+    }
+}
+
+// write to a checkpoint
+void roulette_wheel::save(checkpoint_writer & a_out) const
+{
+    a_out.put_size(m_size);
+    a_out.put_bytes(m_weights,sizeof(double) * m_size);
+    a_out.put(m_total_weight);
+    a_out.put(m_min_weight);
+    a_out.put(m_max_weight);
+}
+
 // assignment operator
 roulette_wheel & roulette_wheel::operator = (const roulette_wheel & a_source)
 {
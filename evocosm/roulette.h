@@ -23,6 +23,7 @@
 
 // libevocosm
 #include "evocommon.h"
+#include "checkpoint.h"
 
 namespace libevocosm
 {
@@ -83,6 +84,21 @@ namespace libevocosm
         */
         roulette_wheel(const roulette_wheel & a_source);
 
+        //! Restoring constructor
+        /*!
+            Creates a wheel from a checkpoint written by save.
+            \param a_in - Checkpoint being read
+        */
+        roulette_wheel(checkpoint_reader & a_in);
+
+        //! Write to a checkpoint
+        /*!
+            Stores the exact weights and total, so that a restored wheel
+            makes the same choices as the original.
+            \param a_out - Checkpoint being written
+        */
+        void save(checkpoint_writer & a_out) const;
+
         //! Assignment operator
         /*!
             Assigns a roulette_wheel the state of another.
@@ -0,0 +1,319 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_SAMPLER_H)
+#define LIBEVOCOSM_SAMPLER_H
+
+// Standard C++ Library
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// libevocosm
+#include "organism.h"
+#include "roulette.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! Picks organisms from a population, weighted by fitness
+    /*!
+        Reproducers and selectors need to pick organisms from a population,
+        favoring the more fit. The classic tool is a roulette wheel, which is
+        rebuilt every generation and depends on the magnitude of fitness
+        values -- and thus on fitness scaling. A parent_sampler abstracts the
+        choice, so that rank- and tournament-based picks can be used instead.
+        <p>
+        A sampler is prepared once for a population, and then asked for any
+        number of indexes into that population.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class parent_sampler : protected globals
+    {
+    public:
+        //! Virtual destructor
+        /*!
+            A virtual destructor. By default, it does nothing; this is
+            a placeholder that identifies this class as a potential base,
+            ensuring that objects of a derived class will have their
+            destructors called if they are destroyed through a base-class
+            pointer.
+        */
+        virtual ~parent_sampler()
+        {
+            // nada
+        }
+
+        //! Prepares to sample a population
+        /*!
+            Called once before picking from a population; the population must
+            not change between a call to prepare and subsequent calls to pick.
+            \param a_population - A population of organisms
+        */
+        virtual void prepare(const vector<OrganismType> & a_population) = 0;
+
+        //! Picks an organism
+        /*!
+            Returns the index of an organism in a prepared population.
+            \param a_population - The population passed to <i>prepare</i>
+            \return Index of the chosen organism
+        */
+        virtual size_t pick(const vector<OrganismType> & a_population) = 0;
+    };
+
+    //! Fitness-proportionate sampling
+    /*!
+        The traditional roulette wheel, where each organism's chance of being
+        picked is proportional to its (non-negative) fitness.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class roulette_sampler : public parent_sampler<OrganismType>
+    {
+    public:
+        //! Constructor
+        roulette_sampler()
+          : m_weights(),
+            m_wheel(NULL)
+        {
+            // nada
+        }
+
+        //! Copy constructor
+        /*!
+            Preparation is not copied; the new sampler must be prepared
+            before use.
+            \param a_source - The source object
+        */
+        roulette_sampler(const roulette_sampler & a_source)
+          : m_weights(),
+            m_wheel(NULL)
+        {
+            // nada
+        }
+
+        //! Destructor
+        virtual ~roulette_sampler()
+        {
+            delete m_wheel;
+        }
+
+        //! Assignment operator
+        /*!
+            Preparation is not copied; the target must be prepared before use.
+            \param a_source - The source object
+            \return A reference to <i>this</i>
+        */
+        roulette_sampler & operator = (const roulette_sampler & a_source)
+        {
+            delete m_wheel;
+            m_wheel = NULL;
+            return *this;
+        }
+
+        //! Builds a roulette wheel for a population
+        /*!
+            \param a_population - A population of organisms
+        */
+        virtual void prepare(const vector<OrganismType> & a_population)
+        {
+            m_weights.resize(a_population.size());
+
+            for (size_t i = 0; i < a_population.size(); ++i)
+                m_weights[i] = (a_population[i].fitness > 0.0) ? a_population[i].fitness : 0.0;
+
+            delete m_wheel;
+            m_wheel = new roulette_wheel(m_weights);
+        }
+
+        //! Spins the wheel
+        /*!
+            \param a_population - The population passed to <i>prepare</i>
+            \return Index of the chosen organism
+        */
+        virtual size_t pick(const vector<OrganismType> & a_population)
+        {
+            return m_wheel->get_index();
+        }
+
+    private:
+        // reused between generations
+        vector<double> m_weights;
+
+        // the wheel for the prepared population
+        roulette_wheel * m_wheel;
+    };
+
+    //! Tournament sampling
+    /*!
+        Picks <i>k</i> organisms at random and returns the most fit of them.
+        Each pick costs O(k), there is nothing to build per generation, and
+        only the order of fitness values matters -- so a population need not
+        be scaled.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class tournament_sampler : public parent_sampler<OrganismType>
+    {
+    public:
+        //! Constructor
+        /*!
+            \param a_size - Number of organisms in each tournament (at least one)
+        */
+        tournament_sampler(size_t a_size = 2)
+          : m_size(a_size > 0 ? a_size : 1)
+        {
+            // nada
+        }
+
+        //! Nothing to prepare
+        /*!
+            \param a_population - A population of organisms
+        */
+        virtual void prepare(const vector<OrganismType> & a_population)
+        {
+            // nada
+        }
+
+        //! Runs a tournament
+        /*!
+            \param a_population - A population of organisms
+            \return Index of the tournament winner
+        */
+        virtual size_t pick(const vector<OrganismType> & a_population)
+        {
+            size_t best = globals::g_random.get_index(a_population.size());
+
+            for (size_t n = 1; n < m_size; ++n)
+            {
+                size_t challenger = globals::g_random.get_index(a_population.size());
+
+                if (a_population[challenger].fitness > a_population[best].fitness)
+                    best = challenger;
+            }
+
+            return best;
+        }
+
+    private:
+        // competitors per tournament
+        size_t m_size;
+    };
+
+    //! Linear rank sampling
+    /*!
+        Chooses organisms by rank rather than by fitness value, with the
+        probability of a pick rising linearly from the worst organism to the
+        best. Selection pressure <i>s</i>, in the range [1,2], is the
+        expected number of times the best organism is picked per <i>N</i>
+        picks from <i>N</i> organisms (exactly <i>s</i> - (<i>s</i> - 1)/<i>N</i>);
+        the worst is picked about 2 - <i>s</i> times. It is not the ratio of
+        the best organism's chance to the worst's. A pressure of 1 samples
+        uniformly, and 2 leaves the worst organism 1/<i>N</i> picks per
+        <i>N</i>.
+        <p>
+        Preparation orders an array of (fitness, index) keys; organisms are
+        never moved or copied. Each pick is O(1), drawing a rank from the
+        inverse of the linear distribution.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class rank_sampler : public parent_sampler<OrganismType>
+    {
+    public:
+        //! Constructor
+        /*!
+            \param a_pressure - Expected picks of the best organism per population-size picks, clamped to [1,2]
+        */
+        rank_sampler(double a_pressure = 1.5)
+          : m_pressure(a_pressure),
+            m_ranks()
+        {
+            if (m_pressure < 1.0)
+                m_pressure = 1.0;
+            else if (m_pressure > 2.0)
+                m_pressure = 2.0;
+        }
+
+        //! Ranks a population
+        /*!
+            \param a_population - A population of organisms
+        */
+        virtual void prepare(const vector<OrganismType> & a_population)
+        {
+            m_ranks.resize(a_population.size());
+
+            for (size_t i = 0; i < a_population.size(); ++i)
+            {
+                m_ranks[i].m_fitness = a_population[i].fitness;
+                m_ranks[i].m_index   = i;
+            }
+
+            // worst first; rank zero is the least fit
+            std::sort(m_ranks.begin(), m_ranks.end());
+        }
+
+        //! Picks an organism by rank
+        /*!
+            \param a_population - The population passed to <i>prepare</i>
+            \return Index of the chosen organism
+        */
+        virtual size_t pick(const vector<OrganismType> & a_population)
+        {
+            // invert F(x) = (2 - s)x + (s - 1)x^2 over x in [0,1)
+            double u = globals::g_random.get_real();
+            double x;
+
+            if (m_pressure == 1.0)
+                x = u;
+            else
+            {
+                double a = m_pressure - 1.0;
+                double b = 2.0 - m_pressure;
+                x = (sqrt(b * b + 4.0 * a * u) - b) / (2.0 * a);
+            }
+
+            size_t rank = static_cast<size_t>(x * static_cast<double>(m_ranks.size()));
+
+            if (rank >= m_ranks.size())
+                rank = m_ranks.size() - 1;
+
+            return m_ranks[rank].m_index;
+        }
+
+    private:
+        // a sortable (fitness, index) pair
+        struct rank_key
+        {
+            double m_fitness;
+            size_t m_index;
+
+            bool operator < (const rank_key & a_right) const
+            {
+                return (m_fitness < a_right.m_fitness);
+            }
+        };
+
+        // selection pressure
+        double m_pressure;
+
+        // indexes ordered by fitness, reused between generations
+        vector<rank_key> m_ranks;
+    };
+};
+
+#endif
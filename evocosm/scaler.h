@@ -19,6 +19,7 @@
 // libevocosm
 #include "organism.h"
 #include "stats.h"
+#include "scaler_kernels.h"
 
 namespace libevocosm
 {
@@ -58,6 +59,54 @@ namespace libevocosm
         virtual void scale_fitness(vector<OrganismType> & a_population) = 0;
     };
 
+    //! A scaler that works on a contiguous buffer of fitness values
+    /*!
+        Fitness values are scattered through a population at the stride of a
+        whole organism. A buffered_scaler gathers them into a reusable
+        contiguous buffer, scales the buffer with the vectorized routines in
+        scaler_kernels, and scatters the results back. Code that already keeps
+        fitness values in their own array can skip the gather and scatter by
+        calling <i>scale_values</i> directly.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class buffered_scaler : public scaler<OrganismType>
+    {
+    public:
+        //! Scale a population's fitness values
+        /*!
+            Gathers fitness values, scales them, and scatters them back into
+            the population.
+            \param a_population - A population of organisms
+        */
+        virtual void scale_fitness(vector<OrganismType> & a_population)
+        {
+            size_t count = a_population.size();
+
+            if (count == 0)
+                return;
+
+            m_buffer.resize(count);
+
+            scaler_kernels::gather(&a_population[0].fitness, sizeof(OrganismType), count, &m_buffer[0]);
+            scale_values(&m_buffer[0], count);
+            scaler_kernels::scatter(&m_buffer[0], count, &a_population[0].fitness, sizeof(OrganismType));
+        }
+
+        //! Scale a contiguous array of fitness values
+        /*!
+            The structure-of-arrays fast path: scales fitness values in place,
+            without reference to any organisms.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
+        */
+        virtual void scale_values(double * a_fitness, size_t a_count) = 0;
+
+    private:
+        // reused between generations to avoid reallocation
+        vector<double> m_buffer;
+    };
+
     //! A do-nothing scaler
     /*!
         The null_scaler doesn't scale anything; it's just a placeholder used
@@ -65,7 +114,7 @@ namespace libevocosm
         \param OrganismType - The type of organism
     */
     template <class OrganismType>
-    class null_scaler : public scaler<OrganismType>
+    class null_scaler : public buffered_scaler<OrganismType>
     {
     public:
         //! Do-nothing scaling function
@@ -77,6 +126,17 @@ namespace libevocosm
         {
             // nada
         }
+
+        //! Do-nothing scaling function
+        /*!
+            Has no effect on the target values.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
+        */
+        virtual void scale_values(double * a_fitness, size_t a_count)
+        {
+            // nada
+        }
     };
 
     //! A linear normalization scaler
@@ -86,7 +146,7 @@ namespace libevocosm
         \param OrganismType - The type of organism
     */
     template <class OrganismType>
-    class linear_norm_scaler : public scaler<OrganismType>
+    class linear_norm_scaler : public buffered_scaler<OrganismType>
     {
     public:
         //! Constructor
@@ -101,37 +161,15 @@ namespace libevocosm
 
         //! Scaling function
         /*!
-            Performs linear normalization on the fitness of the target population.
-            \param a_population - A population of organisms
+            Performs linear normalization on an array of fitness values.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
         */
-        virtual void scale_fitness(vector<OrganismType> & a_population)
+        virtual void scale_values(double * a_fitness, size_t a_count)
         {
             // calculate max, average, and minimum fitness for the population
-            fitness_stats<OrganismType> stats(a_population);
-
-            // calculate coefficients for fitness scaling
-            double slope;
-            double intercept;
-            double delta;
-
-            if (stats.getMin() > ((m_fitness_multiple * stats.getMean() - stats.getMax()) / (m_fitness_multiple - 1.0)))
-            {
-                // normal scaling
-                delta = stats.getMax() - stats.getMean();
-                slope = (m_fitness_multiple - 1.0) * stats.getMean() / delta;
-                intercept = stats.getMean() * (stats.getMax() - m_fitness_multiple * stats.getMean()) / delta;
-            }
-            else
-            {
-                // extreme scaling
-                delta = stats.getMean() - stats.getMin();
-                slope = stats.getMean() / delta;
-                intercept = -stats.getMin() * stats.getMean() / delta;
-            }
-
-            // adjust fitness values
-            for (size_t n = 0; n < a_population.size(); ++n)
-                a_population[n].fitness = slope * a_population[n].fitness + intercept;
+            fitness_summary summary = scaler_kernels::summarize(a_fitness, a_count);
+            scaler_kernels::linear_norm(a_fitness, a_count, summary, m_fitness_multiple);
         }
 
     private:
@@ -145,7 +183,7 @@ namespace libevocosm
         \param OrganismType - The type of organism
     */
     template <class OrganismType>
-    class windowed_scaler : public scaler<OrganismType>
+    class windowed_scaler : public buffered_scaler<OrganismType>
     {
     public:
         //! Constructor
@@ -159,16 +197,14 @@ namespace libevocosm
 
         //! Scaling function
         /*!
-            Performs windowed scaling on the fitness of the target population.
-            \param a_population - A population of organisms
+            Performs windowed scaling on an array of fitness values.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
         */
-        virtual void scale_fitness(vector<OrganismType> & a_population)
+        virtual void scale_values(double * a_fitness, size_t a_count)
         {
-            fitness_stats<OrganismType> stats(a_population);
-
-            // assign new fitness values
-            for (int n = 0; n < a_population.size(); ++n)
-                a_population[n].fitness = stats.getMin();
+            fitness_summary summary = scaler_kernels::summarize(a_fitness, a_count);
+            scaler_kernels::windowed(a_fitness, a_count, summary);
         }
     };
 
@@ -179,7 +215,7 @@ namespace libevocosm
         \param OrganismType - The type of organism
     */
     template <class OrganismType>
-    class exponential_scaler : public scaler<OrganismType>
+    class exponential_scaler : public buffered_scaler<OrganismType>
     {
     public:
         //! Constructor
@@ -200,14 +236,13 @@ namespace libevocosm
 
         //! Scaling function
         /*!
-            Performs exponential scaling on the fitness of the target population.
-            \param a_population - A population of organisms
+            Performs exponential scaling on an array of fitness values.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
         */
-        virtual void scale_fitness(vector<OrganismType> & a_population)
+        virtual void scale_values(double * a_fitness, size_t a_count)
         {
-            // assign new fitness values
-            for (int n = 0; n < a_population.size(); ++n)
-                a_population[n].fitness = pow((m_a * a_population[n].fitness + m_b),m_power);
+            scaler_kernels::exponential(a_fitness, a_count, m_a, m_b, m_power);
         }
 
     private:
@@ -222,7 +257,7 @@ namespace libevocosm
         \param OrganismType - The type of organism
     */
     template <class OrganismType>
-    class quadratic_scaler : public scaler<OrganismType>
+    class quadratic_scaler : public buffered_scaler<OrganismType>
     {
     public:
         //! Constructor
@@ -237,17 +272,13 @@ namespace libevocosm
 
         //! Scaling function
         /*!
-            Performs quadratic scling on the fitness of the target population.
-            \param a_population - A population of organisms
+            Performs quadratic scaling on an array of fitness values.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
         */
-        virtual void scale_fitness(vector<OrganismType> & a_population)
+        virtual void scale_values(double * a_fitness, size_t a_count)
         {
-            // adjust fitness values
-            for (int n = 0; n < a_population.size(); ++n)
-            {
-                double f = a_population[n].fitness;
-                a_population[n].fitness = m_a * pow(f,2.0) + m_b * f + m_c;
-            }
+            scaler_kernels::quadratic(a_fitness, a_count, m_a, m_b, m_c);
         }
 
     private:
@@ -262,7 +293,7 @@ namespace libevocosm
         \param OrganismType - The type of organism
     */
     template <class OrganismType>
-    class sigma_scaler : public scaler<OrganismType>
+    class sigma_scaler : public buffered_scaler<OrganismType>
     {
     public:
         //! Constructor
@@ -279,33 +310,13 @@ namespace libevocosm
             length of a run, thus minimizing the affects of convergence on
             reproductive selection. The function adjusts an organism's fitness
             in relation to the standard deviation of the population's fitness.
-            \param a_population - A population of organisms
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
         */
-        virtual void scale_fitness(vector<OrganismType> & a_population)
+        virtual void scale_values(double * a_fitness, size_t a_count)
         {
-            fitness_stats<OrganismType> stats(a_population);
-
-            // calculate 2 times the std. deviation (sigma)
-            double sigma2 = 2.0 * stats.getSigma();
-
-            // now assign new fitness values
-            if (sigma2 == 0.0)
-            {
-                for (int n = 0; n < a_population.size(); ++n)
-                    a_population[n].fitness = 1.0;
-            }
-            else
-            {
-                for (int n = 0; n < a_population.size(); ++n)
-                {
-                    // change fitness
-                    a_population[n].fitness = (1.0 + a_population[n].fitness / stats.mean) / sigma2;
-
-                    // avoid tiny or zero fitness value; everyone gets to reproduce
-                    if (a_population[n].fitness < 0.1)
-                        a_population[n].fitness = 0.1;
-                }
-            }
+            fitness_summary summary = scaler_kernels::summarize(a_fitness, a_count);
+            scaler_kernels::sigma(a_fitness, a_count, summary);
         }
     };
 
@@ -0,0 +1,198 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cmath>
+#include <limits>
+
+#include "scaler_kernels.h"
+using namespace libevocosm;
+
+// The loops below carry "omp simd" pragmas so that reductions over doubles
+// vectorize without -ffast-math; the library is compiled with -fopenmp-simd,
+// which honors those pragmas without requiring the OpenMP runtime.
+
+// one pass for min, max, mean and variance
+fitness_summary scaler_kernels::summarize(const double * a_fitness, size_t a_count)
+{
+    fitness_summary result = { a_count, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+    if (a_count == 0)
+        return result;
+
+    // sums are shifted by the first value to avoid cancellation in the variance
+    const double shift = a_fitness[0];
+    double min = std::numeric_limits<double>::max();
+    double max = -std::numeric_limits<double>::max();
+    double sum = 0.0;
+    double sum_sq = 0.0;
+
+    #pragma omp simd reduction(min:min) reduction(max:max) reduction(+:sum,sum_sq)
+    for (size_t n = 0; n < a_count; ++n)
+    {
+        double f = a_fitness[n];
+        double d = f - shift;
+        min = (f < min) ? f : min;
+        max = (f > max) ? f : max;
+        sum += d;
+        sum_sq += d * d;
+    }
+
+    double count = static_cast<double>(a_count);
+
+    result.min  = min;
+    result.max  = max;
+    result.mean = shift + sum / count;
+
+    if (a_count > 1)
+    {
+        result.variance = (sum_sq - sum * sum / count) / (count - 1.0);
+
+        if (result.variance < 0.0)
+            result.variance = 0.0;
+    }
+
+    result.sigma = sqrt(result.variance);
+
+    return result;
+}
+
+// strided copy into a contiguous buffer
+void scaler_kernels::gather(const double * a_source, size_t a_stride, size_t a_count, double * a_target)
+{
+    const char * source = reinterpret_cast<const char *>(a_source);
+
+    for (size_t n = 0; n < a_count; ++n, source += a_stride)
+        a_target[n] = *reinterpret_cast<const double *>(source);
+}
+
+// strided copy back from a contiguous buffer
+void scaler_kernels::scatter(const double * a_source, size_t a_count, double * a_target, size_t a_stride)
+{
+    char * target = reinterpret_cast<char *>(a_target);
+
+    for (size_t n = 0; n < a_count; ++n, target += a_stride)
+        *reinterpret_cast<double *>(target) = a_source[n];
+}
+
+// linear normalization
+void scaler_kernels::linear_norm(double * a_fitness, size_t a_count, const fitness_summary & a_summary, double a_fitness_multiple)
+{
+    // calculate coefficients for fitness scaling
+    double slope;
+    double intercept;
+    double delta;
+
+    if (a_summary.min > ((a_fitness_multiple * a_summary.mean - a_summary.max) / (a_fitness_multiple - 1.0)))
+    {
+        // normal scaling
+        delta = a_summary.max - a_summary.mean;
+
+        // identical fitness values can't be normalized
+        if (delta == 0.0)
+            return;
+
+        slope = (a_fitness_multiple - 1.0) * a_summary.mean / delta;
+        intercept = a_summary.mean * (a_summary.max - a_fitness_multiple * a_summary.mean) / delta;
+    }
+    else
+    {
+        // extreme scaling
+        delta = a_summary.mean - a_summary.min;
+
+        if (delta == 0.0)
+            return;
+
+        slope = a_summary.mean / delta;
+        intercept = -a_summary.min * a_summary.mean / delta;
+    }
+
+    #pragma omp simd
+    for (size_t n = 0; n < a_count; ++n)
+        a_fitness[n] = slope * a_fitness[n] + intercept;
+}
+
+// windowed scaling
+void scaler_kernels::windowed(double * a_fitness, size_t a_count, const fitness_summary & a_summary)
+{
+    const double min = a_summary.min;
+
+    #pragma omp simd
+    for (size_t n = 0; n < a_count; ++n)
+        a_fitness[n] -= min;
+}
+
+// exponential scaling
+void scaler_kernels::exponential(double * a_fitness, size_t a_count, double a_a, double a_b, double a_power)
+{
+    if (a_power == 2.0)
+    {
+        #pragma omp simd
+        for (size_t n = 0; n < a_count; ++n)
+        {
+            double v = a_a * a_fitness[n] + a_b;
+            a_fitness[n] = v * v;
+        }
+    }
+    else if (a_power == 1.0)
+    {
+        #pragma omp simd
+        for (size_t n = 0; n < a_count; ++n)
+            a_fitness[n] = a_a * a_fitness[n] + a_b;
+    }
+    else
+    {
+        for (size_t n = 0; n < a_count; ++n)
+            a_fitness[n] = pow(a_a * a_fitness[n] + a_b, a_power);
+    }
+}
+
+// quadratic scaling
+void scaler_kernels::quadratic(double * a_fitness, size_t a_count, double a_a, double a_b, double a_c)
+{
+    // Horner form: (a * f + b) * f + c
+    #pragma omp simd
+    for (size_t n = 0; n < a_count; ++n)
+    {
+        double f = a_fitness[n];
+        a_fitness[n] = (a_a * f + a_b) * f + a_c;
+    }
+}
+
+// sigma scaling
+void scaler_kernels::sigma(double * a_fitness, size_t a_count, const fitness_summary & a_summary)
+{
+    // calculate 2 times the std. deviation (sigma)
+    const double sigma2 = 2.0 * a_summary.sigma;
+
+    if ((sigma2 == 0.0) || (a_summary.mean == 0.0))
+    {
+        #pragma omp simd
+        for (size_t n = 0; n < a_count; ++n)
+            a_fitness[n] = 1.0;
+    }
+    else
+    {
+        const double mean = a_summary.mean;
+
+        #pragma omp simd
+        for (size_t n = 0; n < a_count; ++n)
+        {
+            double f = (1.0 + a_fitness[n] / mean) / sigma2;
+
+            // avoid tiny or zero fitness value; everyone gets to reproduce
+            a_fitness[n] = (f < 0.1) ? 0.1 : f;
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_SCALER_KERNELS_H)
+#define LIBEVOCOSM_SCALER_KERNELS_H
+
+// Standard C++ Library
+#include <cstddef>
+
+namespace libevocosm
+{
+    //! Summary statistics for an array of fitness values
+    /*!
+        A plain set of numbers computed in a single pass over a contiguous
+        array of fitness values; unlike fitness_stats, it does not copy any
+        organisms.
+    */
+    struct fitness_summary
+    {
+        //! Number of values summarized
+        size_t count;
+
+        //! Minimum fitness
+        double min;
+
+        //! Maximum fitness
+        double max;
+
+        //! Mean (average) fitness
+        double mean;
+
+        //! Sample variance of fitness
+        double variance;
+
+        //! Standard deviation (sigma) of fitness
+        double sigma;
+    };
+
+    //! Vectorizable kernels for fitness scaling
+    /*!
+        Scalers spend their time walking a population, one whole organism at a
+        time, to read and write a single double. These kernels work instead on
+        contiguous arrays of fitness values, so that the compiler can vectorize
+        both the statistics and the transforms. The scaler classes use them
+        after gathering fitness into a buffer; code that already keeps fitness
+        in a separate array (structure-of-arrays) can call them directly.
+    */
+    class scaler_kernels
+    {
+    public:
+        //! Computes statistics for an array of fitness values
+        /*!
+            Finds minimum, maximum, mean, and variance in one pass.
+            \param a_fitness - Array of fitness values
+            \param a_count - Number of elements in <i>a_fitness</i>
+            \return Statistics for the array
+        */
+        static fitness_summary summarize(const double * a_fitness, size_t a_count);
+
+        //! Copies fitness values out of strided records
+        /*!
+            Gathers fitness values from an array of records (such as organisms)
+            into a contiguous array.
+            \param a_source - Address of the first fitness value
+            \param a_stride - Distance, in bytes, between consecutive fitness values
+            \param a_count - Number of values to gather
+            \param a_target - Contiguous array receiving the values
+        */
+        static void gather(const double * a_source, size_t a_stride, size_t a_count, double * a_target);
+
+        //! Copies fitness values back into strided records
+        /*!
+            The inverse of <i>gather</i>.
+            \param a_source - Contiguous array of values
+            \param a_count - Number of values to scatter
+            \param a_target - Address of the first fitness value to be replaced
+            \param a_stride - Distance, in bytes, between consecutive fitness values
+        */
+        static void scatter(const double * a_source, size_t a_count, double * a_target, size_t a_stride);
+
+        //! Linear normalization, per Goldberg
+        /*!
+            \param a_fitness - Array of fitness values, modified in place
+            \param a_count - Number of elements in <i>a_fitness</i>
+            \param a_summary - Statistics for <i>a_fitness</i>
+            \param a_fitness_multiple - Target ratio of maximum to mean fitness
+        */
+        static void linear_norm(double * a_fitness, size_t a_count, const fitness_summary & a_summary, double a_fitness_multiple);
+
+        //! Windowed scaling: subtracts the minimum from every value
+        /*!
+            \param a_fitness - Array of fitness values, modified in place
+            \param a_count - Number of elements in <i>a_fitness</i>
+            \param a_summary - Statistics for <i>a_fitness</i>
+        */
+        static void windowed(double * a_fitness, size_t a_count, const fitness_summary & a_summary);
+
+        //! Exponential scaling: (a * f + b) ^ power
+        /*!
+            Squaring, the default power, is computed by multiplication.
+            \param a_fitness - Array of fitness values, modified in place
+            \param a_count - Number of elements in <i>a_fitness</i>
+            \param a_a - Multiplier against fitness
+            \param a_b - Added to fitness before exponentiation
+            \param a_power - Power applied to the value
+        */
+        static void exponential(double * a_fitness, size_t a_count, double a_a, double a_b, double a_power);
+
+        //! Quadratic scaling: a * f^2 + b * f + c
+        /*!
+            \param a_fitness - Array of fitness values, modified in place
+            \param a_count - Number of elements in <i>a_fitness</i>
+            \param a_a - Coefficient of the squared term
+            \param a_b - Coefficient of the linear term
+            \param a_c - Constant term
+        */
+        static void quadratic(double * a_fitness, size_t a_count, double a_a, double a_b, double a_c);
+
+        //! Sigma scaling, per Forrest and Tanese
+        /*!
+            \param a_fitness - Array of fitness values, modified in place
+            \param a_count - Number of elements in <i>a_fitness</i>
+            \param a_summary - Statistics for <i>a_fitness</i>
+        */
+        static void sigma(double * a_fitness, size_t a_count, const fitness_summary & a_summary);
+    };
+};
+
+#endif
@@ -0,0 +1,220 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_SCHEDULER_H)
+#define LIBEVOCOSM_SCHEDULER_H
+
+// Standard C++ Library
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace libevocosm
+{
+    //! Decides what happens when an evocosm yields
+    /*!
+        An evocosm yields between the phases of a generation, giving the
+        program that hosts it a chance to do other work, throttle evolution,
+        pause it, or stop it. The scheduler decides what a yield does; the
+        default does nothing at all, so a yield costs one virtual call.
+    */
+    class scheduler
+    {
+    public:
+        //! Virtual destructor
+        /*!
+            A virtual destructor. By default, it does nothing; this is
+            a placeholder that identifies this class as a potential base,
+            ensuring that objects of a derived class will have their
+            destructors called if they are destroyed through a base-class
+            pointer.
+        */
+        virtual ~scheduler()
+        {
+            // nada
+        }
+
+        //! Yield to the host program
+        /*!
+            Called by an evocosm between phases of processing. May return at
+            once, sleep, or block until evolution should resume.
+            \return <b>true</b> to continue evolution; <b>false</b> to stop
+        */
+        virtual bool yield() = 0;
+    };
+
+    //! A scheduler that never waits
+    /*!
+        The default scheduler: evolution runs flat-out, and is never stopped.
+    */
+    class null_scheduler : public scheduler
+    {
+    public:
+        //! Do-nothing yield
+        /*!
+            \return Always <b>true</b>
+        */
+        virtual bool yield()
+        {
+            return true;
+        }
+    };
+
+    //! A scheduler that calls a user function
+    /*!
+        Lets a host program do its own cooperative multitasking -- pumping
+        an event loop, for example -- whenever the evocosm yields.
+    */
+    class callback_scheduler : public scheduler
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_callback - Called on each yield; returns <b>false</b> to stop evolution
+        */
+        callback_scheduler(const std::function<bool ()> & a_callback)
+          : m_callback(a_callback)
+        {
+            // nada
+        }
+
+        //! Calls the user function
+        /*!
+            \return The value returned by the user function
+        */
+        virtual bool yield()
+        {
+            return m_callback();
+        }
+
+    private:
+        // the user function
+        std::function<bool ()> m_callback;
+    };
+
+    //! A scheduler that can pause, throttle, or cancel evolution
+    /*!
+        A control_scheduler is a token shared between an evocosm and the
+        threads that manage it. Another thread may pause evolution (the
+        evocosm blocks at its next yield until resumed), cancel it (the
+        evocosm stops at its next yield), or throttle it (each yield sleeps
+        for a given time). While none of these is in effect, a yield is a
+        couple of atomic loads.
+    */
+    class control_scheduler : public scheduler
+    {
+    public:
+        //! Constructor
+        control_scheduler()
+          : m_cancelled(false),
+            m_paused(false),
+            m_throttle(0),
+            m_mutex(),
+            m_resumed()
+        {
+            // nada
+        }
+
+        //! Stop evolution at the next yield
+        void cancel()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_cancelled.store(true);
+            m_resumed.notify_all();
+        }
+
+        //! Block evolution at the next yield
+        void pause()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_paused.store(true);
+        }
+
+        //! Let paused evolution continue
+        void resume()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_paused.store(false);
+            m_resumed.notify_all();
+        }
+
+        //! Set a delay for each yield
+        /*!
+            \param a_microseconds - Time to sleep on each yield; zero for none
+        */
+        void set_throttle(unsigned int a_microseconds)
+        {
+            m_throttle.store(a_microseconds, std::memory_order_relaxed);
+        }
+
+        //! Has evolution been cancelled?
+        bool is_cancelled() const
+        {
+            return m_cancelled.load();
+        }
+
+        //! Is evolution paused?
+        bool is_paused() const
+        {
+            return m_paused.load();
+        }
+
+        //! Applies pause, throttle, and cancellation
+        /*!
+            \return <b>false</b> if evolution has been cancelled
+        */
+        virtual bool yield()
+        {
+            if (m_paused.load(std::memory_order_acquire))
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+
+                while (m_paused.load() && !m_cancelled.load())
+                    m_resumed.wait(lock);
+            }
+
+            if (m_cancelled.load(std::memory_order_acquire))
+                return false;
+
+            unsigned int throttle = m_throttle.load(std::memory_order_relaxed);
+
+            if (throttle > 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(throttle));
+
+            return true;
+        }
+
+    private:
+        // stop at next yield
+        std::atomic<bool> m_cancelled;
+
+        // block at next yield
+        std::atomic<bool> m_paused;
+
+        // sleep time per yield, in microseconds
+        std::atomic<unsigned int> m_throttle;
+
+        // guards waiting while paused
+        std::mutex m_mutex;
+
+        // signals resumption or cancellation
+        std::condition_variable m_resumed;
+    };
+};
+
+#endif
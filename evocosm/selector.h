@@ -21,6 +21,7 @@
 
 // libevocosm
 #include "organism.h"
+#include "sampler.h"
 
 namespace libevocosm
 {
@@ -192,6 +193,208 @@ namespace libevocosm
         return chosen_ones;
     }
 
+    //! Implements tournament selection
+    /*!
+        Survivors are the winners of a series of tournaments, each among a
+        few organisms chosen at random. Only the order of fitness values
+        matters, so the population needn't be scaled first. Organisms may
+        win more than one tournament.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class tournament_selector : public selector<OrganismType>
+    {
+    public:
+        //! Constructor
+        /*!
+            \param a_survival - Fraction of the population that survives, in [0,1]
+            \param a_size - Number of organisms in each tournament
+        */
+        tournament_selector(double a_survival = 0.5, size_t a_size = 2)
+          : m_survival(a_survival),
+            m_sampler(a_size)
+        {
+            if (m_survival < 0.0)
+                m_survival = 0.0;
+            else if (m_survival > 1.0)
+                m_survival = 1.0;
+        }
+
+        //! Select individuals that survive
+        /*!
+            Produces a vector containing copies of the organisms selected for
+            survival.
+            \param a_population - A population of organisms
+            \return A population of copied survivors
+        */
+        virtual vector<OrganismType> select_survivors(vector<OrganismType> & a_population)
+        {
+            size_t count = static_cast<size_t>(m_survival * static_cast<double>(a_population.size()));
+
+            vector<OrganismType> chosen_ones;
+            chosen_ones.reserve(count);
+
+            m_sampler.prepare(a_population);
+
+            for (size_t n = 0; n < count; ++n)
+                chosen_ones.push_back(a_population[m_sampler.pick(a_population)]);
+
+            return chosen_ones;
+        }
+
+    private:
+        // fraction of the population that survives
+        double m_survival;
+
+        // runs tournaments
+        tournament_sampler<OrganismType> m_sampler;
+    };
+
+    //! Implements linear rank selection
+    /*!
+        Survivors are drawn with a probability that rises linearly with their
+        rank in the population, independent of the magnitude of fitness
+        values. Organisms may be drawn more than once.
+        \param OrganismType - The type of organism
+        \sa rank_sampler
+    */
+    template <class OrganismType>
+    class rank_selector : public selector<OrganismType>
+    {
+    public:
+        //! Constructor
+        /*!
+            \param a_survival - Fraction of the population that survives, in [0,1]
+            \param a_pressure - Selection pressure: about how many times the best organism is drawn per population-size draws, in [1,2]
+        */
+        rank_selector(double a_survival = 0.5, double a_pressure = 1.5)
+          : m_survival(a_survival),
+            m_sampler(a_pressure)
+        {
+            if (m_survival < 0.0)
+                m_survival = 0.0;
+            else if (m_survival > 1.0)
+                m_survival = 1.0;
+        }
+
+        //! Select individuals that survive
+        /*!
+            Produces a vector containing copies of the organisms selected for
+            survival.
+            \param a_population - A population of organisms
+            \return A population of copied survivors
+        */
+        virtual vector<OrganismType> select_survivors(vector<OrganismType> & a_population)
+        {
+            size_t count = static_cast<size_t>(m_survival * static_cast<double>(a_population.size()));
+
+            vector<OrganismType> chosen_ones;
+            chosen_ones.reserve(count);
+
+            m_sampler.prepare(a_population);
+
+            for (size_t n = 0; n < count; ++n)
+                chosen_ones.push_back(a_population[m_sampler.pick(a_population)]);
+
+            return chosen_ones;
+        }
+
+    private:
+        // fraction of the population that survives
+        double m_survival;
+
+        // ranks the population
+        rank_sampler<OrganismType> m_sampler;
+    };
+
+    //! Implements truncation selection
+    /*!
+        The <i>k</i> most fit organisms survive, no more and no less. Unlike
+        elitism_selector, whose survivors depend on how fitness values are
+        spread, a truncation_selector always produces the same number of
+        survivors -- so the number of children to breed each generation is
+        known in advance. Survivors are found with std::nth_element over an
+        array of (fitness, index) keys, in O(N) time, without moving any
+        organisms.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class truncation_selector : public selector<OrganismType>
+    {
+    public:
+        //! Constructor
+        /*!
+            \param a_count - Number of organisms that survive
+        */
+        truncation_selector(size_t a_count)
+          : m_count(a_count),
+            m_keys()
+        {
+            // nada
+        }
+
+        //! Get survivor count
+        /*!
+            \return The number of organisms that survive each generation
+        */
+        size_t survivor_count() const
+        {
+            return m_count;
+        }
+
+        //! Select individuals that survive
+        /*!
+            Produces a vector containing copies of the <i>k</i> best organisms,
+            in no particular order.
+            \param a_population - A population of organisms
+            \return A population of copied survivors
+        */
+        virtual vector<OrganismType> select_survivors(vector<OrganismType> & a_population)
+        {
+            size_t count = (m_count < a_population.size()) ? m_count : a_population.size();
+
+            m_keys.resize(a_population.size());
+
+            for (size_t n = 0; n < a_population.size(); ++n)
+            {
+                m_keys[n].m_fitness = a_population[n].fitness;
+                m_keys[n].m_index   = n;
+            }
+
+            // partition the best to the front
+            if (count < m_keys.size())
+                std::nth_element(m_keys.begin(), m_keys.begin() + count, m_keys.end());
+
+            // children are appended to survivors, so room is reserved for a full population
+            vector<OrganismType> chosen_ones;
+            chosen_ones.reserve(a_population.size());
+
+            for (size_t n = 0; n < count; ++n)
+                chosen_ones.push_back(a_population[m_keys[n].m_index]);
+
+            return chosen_ones;
+        }
+
+    private:
+        // a (fitness, index) pair ordered best first
+        struct truncation_key
+        {
+            double m_fitness;
+            size_t m_index;
+
+            bool operator < (const truncation_key & a_right) const
+            {
+                return (m_fitness > a_right.m_fitness);
+            }
+        };
+
+        // number of organisms to keep
+        size_t m_count;
+
+        // reused between generations
+        vector<truncation_key> m_keys;
+    };
+
 };
 
 #endif
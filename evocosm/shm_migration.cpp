@@ -0,0 +1,299 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "shm_migration.h"
+using namespace libevocosm;
+
+// identifies the shared memory
+static const char SHM_MAGIC[8] = { 'E', 'V', 'O', 'S', 'H', 'M', '0', '1' };
+
+// start of the region
+struct shm_header
+{
+    char             magic[8];
+    uint64_t         rings;
+    uint64_t         slots;
+    uint64_t         slot_size;
+    migration_status status;
+};
+
+// positions of a ring, on separate cache lines
+struct shm_ring_control
+{
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+};
+
+// a message slot; the message follows
+struct shm_slot
+{
+    std::atomic<uint64_t> sequence;
+    uint64_t              length;
+};
+
+// round a size up to whole cache lines
+static size_t cache_lines(size_t a_bytes)
+{
+    return (a_bytes + 63) / 64 * 64;
+}
+
+// constructor
+shm_rings::shm_rings(const std::string & a_name, size_t a_rings, size_t a_slots, size_t a_slot_size)
+  : m_name(a_name),
+    m_owner(getpid()),
+    m_base(NULL),
+    m_length(0),
+    m_rings(a_rings),
+    m_slots(2),
+    m_slot_size(a_slot_size),
+    m_stride(0),
+    m_ring_size(0)
+{
+    if ((m_rings == 0) || (m_slot_size == 0))
+        throw std::runtime_error("invalid shm_rings creation parameters");
+
+    // processes can only share atomics that don't hide a lock
+    std::atomic<uint64_t> probe(0);
+    std::atomic<bool> flag(false);
+
+    if (!probe.is_lock_free() || !flag.is_lock_free())
+        throw std::runtime_error("shm_rings requires lock-free atomics");
+
+    while (m_slots < a_slots)
+        m_slots <<= 1;
+
+    m_stride    = cache_lines(sizeof(shm_slot) + m_slot_size);
+    m_ring_size = sizeof(shm_ring_control) + m_slots * m_stride;
+    m_length    = cache_lines(sizeof(shm_header)) + m_rings * m_ring_size;
+
+    int fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (fd < 0)
+        throw std::runtime_error("unable to create shared memory " + m_name + ": " + strerror(errno));
+
+    if (ftruncate(fd, static_cast<off_t>(m_length)) != 0)
+    {
+        close(fd);
+        shm_unlink(m_name.c_str());
+        throw std::runtime_error("unable to size shared memory " + m_name);
+    }
+
+    void * base = mmap(NULL, m_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (base == MAP_FAILED)
+    {
+        shm_unlink(m_name.c_str());
+        throw std::runtime_error("unable to map shared memory " + m_name);
+    }
+
+    m_base = static_cast<unsigned char *>(base);
+
+    // the new object is zero-filled; construct the atomics in place
+    shm_header * header = new (m_base) shm_header;
+    memcpy(header->magic, SHM_MAGIC, sizeof(SHM_MAGIC));
+    header->rings     = m_rings;
+    header->slots     = m_slots;
+    header->slot_size = m_slot_size;
+    header->status.stop.store(false);
+    header->status.sent.store(0);
+    header->status.dropped.store(0);
+
+    for (size_t r = 0; r < m_rings; ++r)
+    {
+        unsigned char * ring = m_base + cache_lines(sizeof(shm_header)) + r * m_ring_size;
+        new (ring) shm_ring_control;
+
+        for (size_t n = 0; n < m_slots; ++n)
+            new (ring + sizeof(shm_ring_control) + n * m_stride) shm_slot;
+    }
+
+    reset();
+}
+
+// destructor
+shm_rings::~shm_rings()
+{
+    munmap(m_base, m_length);
+
+    // forked processes share the mapping, but only the creator removes the name
+    if (getpid() == m_owner)
+        shm_unlink(m_name.c_str());
+}
+
+// the shared status
+migration_status & shm_rings::status()
+{
+    return reinterpret_cast<shm_header *>(m_base)->status;
+}
+
+// empty every ring
+void shm_rings::reset()
+{
+    for (size_t r = 0; r < m_rings; ++r)
+    {
+        unsigned char * ring = m_base + cache_lines(sizeof(shm_header)) + r * m_ring_size;
+
+        shm_ring_control * control = reinterpret_cast<shm_ring_control *>(ring);
+        control->head.store(0);
+        control->tail.store(0);
+
+        for (size_t n = 0; n < m_slots; ++n)
+        {
+            shm_slot * slot = reinterpret_cast<shm_slot *>(ring + sizeof(shm_ring_control) + n * m_stride);
+            slot->sequence.store(n);
+            slot->length = 0;
+        }
+    }
+}
+
+// add a message
+bool shm_rings::push(size_t a_ring, const void * a_data, size_t a_length)
+{
+    if (a_length > m_slot_size)
+        return false;
+
+    unsigned char * ring = m_base + cache_lines(sizeof(shm_header)) + a_ring * m_ring_size;
+    shm_ring_control * control = reinterpret_cast<shm_ring_control *>(ring);
+    uint64_t pos = control->tail.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        unsigned char * cell = ring + sizeof(shm_ring_control) + (pos & (m_slots - 1)) * m_stride;
+        shm_slot * slot = reinterpret_cast<shm_slot *>(cell);
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+
+        if (diff == 0)
+        {
+            if (control->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot->length = a_length;
+                memcpy(cell + sizeof(shm_slot), a_data, a_length);
+                slot->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = control->tail.load(std::memory_order_relaxed);
+    }
+}
+
+// take a message
+bool shm_rings::pop(size_t a_ring, vector<unsigned char> & a_data)
+{
+    unsigned char * ring = m_base + cache_lines(sizeof(shm_header)) + a_ring * m_ring_size;
+    shm_ring_control * control = reinterpret_cast<shm_ring_control *>(ring);
+    uint64_t pos = control->head.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        unsigned char * cell = ring + sizeof(shm_ring_control) + (pos & (m_slots - 1)) * m_stride;
+        shm_slot * slot = reinterpret_cast<shm_slot *>(cell);
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+
+        if (diff == 0)
+        {
+            if (control->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                const unsigned char * message = cell + sizeof(shm_slot);
+                a_data.assign(message, message + slot->length);
+                slot->sequence.store(pos + m_slots, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+            return false;
+        else
+            pos = control->head.load(std::memory_order_relaxed);
+    }
+}
+
+// write a length and the bytes
+bool libevocosm::write_image(int a_fd, const vector<unsigned char> & a_image)
+{
+    uint64_t length = a_image.size();
+    const unsigned char * data[2] = { reinterpret_cast<const unsigned char *>(&length), a_image.data() };
+    size_t sizes[2] = { sizeof(length), a_image.size() };
+
+    for (size_t n = 0; n < 2; ++n)
+    {
+        size_t done = 0;
+
+        while (done < sizes[n])
+        {
+            ssize_t count = write(a_fd, data[n] + done, sizes[n] - done);
+
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return false;
+            }
+
+            done += static_cast<size_t>(count);
+        }
+    }
+
+    return true;
+}
+
+// read a length and the bytes
+bool libevocosm::read_image(int a_fd, vector<unsigned char> & a_image)
+{
+    uint64_t length = 0;
+    unsigned char * data = reinterpret_cast<unsigned char *>(&length);
+    size_t size = sizeof(length);
+
+    for (size_t n = 0; n < 2; ++n)
+    {
+        size_t done = 0;
+
+        while (done < size)
+        {
+            ssize_t count = read(a_fd, data + done, size - done);
+
+            if ((count < 0) && (errno == EINTR))
+                continue;
+
+            if (count <= 0)
+                return false;
+
+            done += static_cast<size_t>(count);
+        }
+
+        if (n == 0)
+        {
+            a_image.resize(static_cast<size_t>(length));
+            data = a_image.data();
+            size = a_image.size();
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,425 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_SHM_MIGRATION_H)
+#define LIBEVOCOSM_SHM_MIGRATION_H
+
+// Standard C++ Library
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// POSIX
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// libevocosm
+#include "archipelago.h"
+#include "checkpoint.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! Lock-free rings of byte messages in POSIX shared memory
+    /*!
+        A set of bounded MPMC rings (the same algorithm as mpmc_queue) whose
+        slots hold messages of up to a fixed size. The memory is created
+        with <i>shm_open</i> and mapped shared, so processes forked after
+        construction all see the same rings; no operation locks or blocks.
+        The region also holds the migration_status for an archipelago.
+        <p>
+        A process that dies between claiming a slot and finishing with it
+        leaves that slot claimed for good, and the ring stops at it until
+        reset empties every ring.
+        <p>
+        The process that creates the rings removes the shared memory object
+        when it destroys them.
+    */
+    class shm_rings
+    {
+    public:
+        //! Creation constructor
+        /*!
+            Creates a new shared memory object; std::runtime_error is thrown
+            if the name is in use, or if the platform's 64-bit atomics aren't
+            lock-free.
+            \param a_name - Name of the shared memory object (e.g., "/evocosm-islands")
+            \param a_rings - Number of rings
+            \param a_slots - Minimum number of messages per ring; rounded up to a power of two
+            \param a_slot_size - Largest message, in bytes
+        */
+        shm_rings(const std::string & a_name, size_t a_rings, size_t a_slots, size_t a_slot_size);
+
+        //! Destructor
+        ~shm_rings();
+
+        //! Add a message to a ring
+        /*!
+            \param a_ring - Index of the ring
+            \param a_data - Start of the message
+            \param a_length - Bytes in the message
+            \return <b>false</b> if the ring is full or the message too large
+        */
+        bool push(size_t a_ring, const void * a_data, size_t a_length);
+
+        //! Take a message from a ring
+        /*!
+            \param a_ring - Index of the ring
+            \param a_data - Receives the message
+            \return <b>false</b> if the ring is empty
+        */
+        bool pop(size_t a_ring, vector<unsigned char> & a_data);
+
+        //! Empty every ring
+        /*!
+            Discards all messages, and frees slots left claimed by a process
+            that died. Only safe while no other process is using the rings.
+        */
+        void reset();
+
+        //! Get the shared migration status
+        migration_status & status();
+
+        //! Get the largest message size
+        size_t slot_size() const
+        {
+            return m_slot_size;
+        }
+
+    private:
+        // not copyable
+        shm_rings(const shm_rings &);
+        shm_rings & operator = (const shm_rings &);
+
+        // name of the shared memory object
+        std::string m_name;
+
+        // process that created it
+        pid_t m_owner;
+
+        // the mapping
+        unsigned char * m_base;
+
+        // size of the mapping
+        size_t m_length;
+
+        // number of rings
+        size_t m_rings;
+
+        // slots per ring
+        size_t m_slots;
+
+        // largest message
+        size_t m_slot_size;
+
+        // bytes between slots
+        size_t m_stride;
+
+        // bytes per ring
+        size_t m_ring_size;
+    };
+
+    //! Write a length-prefixed image to a file descriptor
+    /*!
+        \param a_fd - File descriptor, usually one end of a pipe
+        \param a_image - Bytes to write
+        \return <b>false</b> on error
+    */
+    bool write_image(int a_fd, const vector<unsigned char> & a_image);
+
+    //! Read a length-prefixed image from a file descriptor
+    /*!
+        \param a_fd - File descriptor, usually one end of a pipe
+        \param a_image - Receives the bytes
+        \return <b>false</b> on error or a short read
+    */
+    bool read_image(int a_fd, vector<unsigned char> & a_image);
+
+    //! Carries migrants between processes through shared memory
+    /*!
+        Migrants are serialized with organism_serializer (fitness and genes)
+        into shm_rings, one ring per island; genes of type vector<double>,
+        simple_machine, and fuzzy_machine are supported, as is any type with
+        a serializer. A migrant too large for a slot is dropped.
+        <p>
+        Create the channel before forking islands.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class shm_channel : public migration_channel<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_name - Name of the shared memory object
+            \param a_islands - Number of islands
+            \param a_slots - Minimum number of migrants each mailbox can hold
+            \param a_slot_size - Largest serialized migrant, in bytes
+        */
+        shm_channel(const std::string & a_name, size_t a_islands, size_t a_slots = 64, size_t a_slot_size = 4096)
+          : m_rings(a_name, a_islands, a_slots, a_slot_size)
+        {
+            // nada
+        }
+
+        //! Send a migrant
+        virtual bool post(size_t a_island, const OrganismType & a_migrant)
+        {
+            checkpoint_writer image;
+            organism_serializer<OrganismType>::write(image, a_migrant);
+            return m_rings.push(a_island, image.data().data(), image.data().size());
+        }
+
+        //! Receive a migrant
+        virtual bool collect(size_t a_island, vector<OrganismType> & a_arrivals)
+        {
+            vector<unsigned char> data;
+
+            if (!m_rings.pop(a_island, data))
+                return false;
+
+            checkpoint_reader image(data);
+            a_arrivals.push_back(organism_serializer<OrganismType>::read(image));
+            return true;
+        }
+
+        //! Get the shared status
+        virtual migration_status & status()
+        {
+            return m_rings.status();
+        }
+
+        //! Empty every mailbox
+        /*!
+            Only safe while no island process is running.
+        */
+        void reset()
+        {
+            m_rings.reset();
+        }
+
+    private:
+        // the mailboxes
+        shm_rings m_rings;
+    };
+
+    //! Runs the islands of an archipelago as separate processes
+    /*!
+        Each island is forked into its own process, which evolves it and
+        exchanges migrants through a shm_channel; a crash in one island's
+        fitness function kills only that process, and islands don't
+        contend for one heap. When an island finishes, its process sends a
+        checkpoint of the island back through a pipe, and the launcher
+        restores it into the island's evocosm, so after run the islands hold
+        their final populations just as they would with threads.
+        <p>
+        The evocosms and their components are copied into each process by
+        <i>fork</i>; the launching process should have no other threads
+        running. Islands that crash are reported by get_failures and left
+        as they were before the run. The random number generator of the
+        calling thread is not disturbed.
+        <p>
+        An island that dies while posting or collecting a migrant can leave
+        a mailbox slot claimed, which stops migration through that mailbox
+        for the rest of the run; the other islands run on regardless. When
+        an island failed, the next run empties every mailbox before forking,
+        discarding migrants left in them.
+        <p>
+        Requires POSIX <i>fork</i> and shared memory.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class process_archipelago : public archipelago<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_islands - The islands; the evocosms must outlive the archipelago
+            \param a_channel - Carries migrants; must have a mailbox for every island
+            \param a_topology - How islands are connected
+            \param a_interval - Generations between migrations
+            \param a_migrants - Organisms each island sends to each neighbour
+            \param a_policy - Which organisms emigrate
+            \param a_seed - Seed from which each island's random stream is derived
+        */
+        process_archipelago(const vector<evocosm<OrganismType> *> &                a_islands,
+                            shm_channel<OrganismType> &                            a_channel,
+                            typename archipelago<OrganismType>::topology           a_topology = archipelago<OrganismType>::TOPOLOGY_RING,
+                            size_t                                                 a_interval = 10,
+                            size_t                                                 a_migrants = 1,
+                            typename archipelago<OrganismType>::migration_policy   a_policy = archipelago<OrganismType>::MIGRATE_BEST,
+                            unsigned long long int                                 a_seed = (unsigned long long int)(time(nullptr)))
+          : archipelago<OrganismType>(a_islands, a_topology, a_interval, a_migrants, a_policy, a_seed),
+            m_shm_channel(a_channel),
+            m_failed(a_islands.size(), false)
+        {
+            m_channel = &a_channel;
+        }
+
+        //! Run the islands
+        /*!
+            Forks a process for each island and waits for all of them.
+            \param a_generations - Maximum number of generations per island
+            \return <b>true</b> if every island ran all its generations
+        */
+        bool run(size_t a_generations);
+
+        //! Get the number of islands whose process failed in the last run
+        size_t get_failures() const
+        {
+            size_t result = 0;
+
+            for (size_t n = 0; n < m_failed.size(); ++n)
+            {
+                if (m_failed[n])
+                    ++result;
+            }
+
+            return result;
+        }
+
+        //! Did an island's process fail in the last run?
+        bool has_failed(size_t a_island) const
+        {
+            return m_failed[a_island];
+        }
+
+    protected:
+        using archipelago<OrganismType>::m_islands;
+        using archipelago<OrganismType>::m_channel;
+
+    private:
+        // the shared mailboxes
+        shm_channel<OrganismType> & m_shm_channel;
+
+        // islands whose process crashed or threw
+        vector<bool> m_failed;
+    };
+
+    // run islands in processes
+    template <class OrganismType>
+    bool process_archipelago<OrganismType>::run(size_t a_generations)
+    {
+        size_t count = m_islands.size();
+        vector<pid_t> pids(count, -1);
+        vector<int> results(count, -1);
+
+        // a process that died in the last run may have left a mailbox stuck
+        if (get_failures() > 0)
+            m_shm_channel.reset();
+
+        m_channel->status().stop.store(false);
+        m_failed.assign(count, false);
+
+        // children must not inherit unwritten output
+        fflush(NULL);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            int fds[2];
+
+            if (pipe(fds) != 0)
+            {
+                m_failed[i] = true;
+                continue;
+            }
+
+            pid_t pid = fork();
+
+            if (pid == 0)
+            {
+                // the island's process
+                for (size_t n = 0; n < i; ++n)
+                {
+                    if (results[n] >= 0)
+                        close(results[n]);
+                }
+
+                close(fds[0]);
+
+                int code = 1;
+
+                if (this->run_island(i, a_generations))
+                {
+                    checkpoint_writer image;
+                    m_islands[i]->save_checkpoint(image);
+
+                    if (write_image(fds[1], image.data()))
+                        code = 0;
+                }
+
+                close(fds[1]);
+                fflush(NULL);
+                _exit(code);
+            }
+
+            close(fds[1]);
+
+            if (pid < 0)
+            {
+                close(fds[0]);
+                m_failed[i] = true;
+            }
+            else
+            {
+                pids[i] = pid;
+                results[i] = fds[0];
+            }
+        }
+
+        // results are restored without disturbing the caller's random sequence
+        unsigned long long int random_state[prng::STATE_WORDS];
+        globals::g_random.get_state(random_state);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (pids[i] < 0)
+                continue;
+
+            vector<unsigned char> image;
+            bool ok = read_image(results[i], image);
+            close(results[i]);
+
+            int status = 0;
+            waitpid(pids[i], &status, 0);
+
+            ok = ok && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+
+            if (ok)
+            {
+                try
+                {
+                    checkpoint_reader reader(image);
+                    m_islands[i]->restore_checkpoint(reader);
+                }
+                catch (std::runtime_error &)
+                {
+                    ok = false;
+                }
+            }
+
+            m_failed[i] = !ok;
+        }
+
+        globals::g_random.set_state(random_state);
+
+        return !m_channel->status().stop.load() && (get_failures() == 0);
+    }
+};
+
+#endif
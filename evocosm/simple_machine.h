@@ -25,6 +25,9 @@ using namespace std;
 // libevocosm
 #include "evocommon.h"
 #include "machine_tools.h"
+#include "genome_pool.h"
+#include "metrics.h"
+#include "checkpoint.h"
 
 namespace libevocosm
 {
@@ -49,6 +52,30 @@ namespace libevocosm
 
             //! The output value
             size_t m_output;
+
+            //! Allocation from the genome pool
+            static void * operator new (size_t a_bytes)
+            {
+                return genome_pool::allocate(a_bytes);
+            }
+
+            //! Allocation from the genome pool
+            static void * operator new [] (size_t a_bytes)
+            {
+                return genome_pool::allocate(a_bytes);
+            }
+
+            //! Return to the genome pool
+            static void operator delete (void * a_block, size_t a_bytes)
+            {
+                genome_pool::deallocate(a_block, a_bytes);
+            }
+
+            //! Return to the genome pool
+            static void operator delete [] (void * a_block, size_t a_bytes)
+            {
+                genome_pool::deallocate(a_block, a_bytes);
+            }
         };
 
         //! Creation constructor
@@ -73,6 +100,20 @@ namespace libevocosm
         */
         simple_machine(const simple_machine<InSize,OutSize> & a_source);
 
+        //! Restoring constructor
+        /*!
+            Creates a simple_machine from a checkpoint written by save. Throws
+            std::runtime_error if the stored machine doesn't fit this type.
+            \param a_in - Checkpoint being read
+        */
+        simple_machine(checkpoint_reader & a_in);
+
+        //! Write to a checkpoint
+        /*!
+            \param a_out - Checkpoint being written
+        */
+        void save(checkpoint_writer & a_out) const;
+
         //! Virtual destructor
         /*!
             Does nothing in the base class; exists to allow destruction of derived
@@ -206,7 +247,7 @@ namespace libevocosm
         for (size_t s = 0; s < m_size; ++s)
             delete [] m_state_table[s];
 
-        delete [] m_state_table;
+        genome_pool::deallocate(m_state_table, sizeof(tranout_t *) * m_size);
     }
 
     // deep copy
@@ -214,7 +255,7 @@ namespace libevocosm
     void simple_machine<InSize,OutSize>::deep_copy(const simple_machine<InSize,OutSize> & a_source)
     {
         // allocate state table
-        m_state_table = new tranout_t * [m_size];
+        m_state_table = static_cast<tranout_t **>(genome_pool::allocate(sizeof(tranout_t *) * m_size));
 
         for (size_t s = 0; s < m_size; ++s)
         {
@@ -243,7 +284,7 @@ namespace libevocosm
             throw std::runtime_error("invalid simple_machine creation parameters");
 
         // allocate state table
-        m_state_table = new tranout_t * [m_size];
+        m_state_table = static_cast<tranout_t **>(genome_pool::allocate(sizeof(tranout_t *) * m_size));
 
         for (size_t s = 0; s < m_size; ++s)
         {
@@ -313,6 +354,75 @@ namespace libevocosm
         deep_copy(a_source);
     }
 
+    //  Restoring constructor
+    template <size_t InSize, size_t OutSize>
+    simple_machine<InSize,OutSize>::simple_machine(checkpoint_reader & a_in)
+      : m_state_table(NULL),
+        m_init_state(0),
+        m_current_state(0),
+        m_size(0)
+    {
+        size_t in_size  = a_in.get_size();
+        size_t out_size = a_in.get_size();
+        size_t size     = a_in.get_size();
+
+        if ((in_size != InSize) || (out_size != OutSize) || (size < 2))
+            throw std::runtime_error("invalid simple_machine checkpoint");
+
+        size_t init_state    = a_in.get_size();
+        size_t current_state = a_in.get_size();
+
+        // read into a plain vector first, so nothing leaks if the checkpoint is bad
+        vector<size_t> table(size * InSize * 2);
+
+        for (size_t n = 0; n < table.size(); ++n)
+        {
+            table[n] = a_in.get_size();
+
+            if (table[n] >= ((n & 1) ? OutSize : size))
+                throw std::runtime_error("invalid simple_machine checkpoint");
+        }
+
+        if ((init_state >= size) || (current_state >= size))
+            throw std::runtime_error("invalid simple_machine checkpoint");
+
+        m_size          = size;
+        m_init_state    = init_state;
+        m_current_state = current_state;
+        m_state_table   = static_cast<tranout_t **>(genome_pool::allocate(sizeof(tranout_t *) * m_size));
+
+        for (size_t s = 0; s < m_size; ++s)
+        {
+            m_state_table[s] = new tranout_t [InSize];
+
+            for (size_t i = 0; i < InSize; ++i)
+            {
+                m_state_table[s][i].m_new_state = table[(s * InSize + i) * 2];
+                m_state_table[s][i].m_output    = table[(s * InSize + i) * 2 + 1];
+            }
+        }
+    }
+
+    //  Write to a checkpoint
+    template <size_t InSize, size_t OutSize>
+    void simple_machine<InSize,OutSize>::save(checkpoint_writer & a_out) const
+    {
+        a_out.put_size(InSize);
+        a_out.put_size(OutSize);
+        a_out.put_size(m_size);
+        a_out.put_size(m_init_state);
+        a_out.put_size(m_current_state);
+
+        for (size_t s = 0; s < m_size; ++s)
+        {
+            for (size_t i = 0; i < InSize; ++i)
+            {
+                a_out.put_size(m_state_table[s][i].m_new_state);
+                a_out.put_size(m_state_table[s][i].m_output);
+            }
+        }
+    }
+
     //  Virtual destructor
     template <size_t InSize, size_t OutSize>
     simple_machine<InSize,OutSize>::~simple_machine()
@@ -351,10 +461,16 @@ namespace libevocosm
     {
         // the number of chances for mutation is based on the number of states in the machine;
         // larger machines thus encounter more mutations
+        prng & random = g_random;
+
         for (size_t n = 0; n < m_size; ++n)
         {
-            if (g_random.get_real() < a_rate)
+            if (random.get_real() < a_rate)
             {
+#if defined(EVOCOSM_METRICS)
+                metrics_recorder::count_mutation();
+#endif
+
                 // pick a mutation
                 switch (g_selector.get_index())
                 {
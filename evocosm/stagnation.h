@@ -0,0 +1,319 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_STAGNATION_H)
+#define LIBEVOCOSM_STAGNATION_H
+
+// Standard C++ Library
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// libevocosm
+#include "analyzer.h"
+#include "checkpoint.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! Hashes genes, for stagnation_analyzer
+    /*!
+        By default, genes are serialized (see serializer) into a scratch
+        buffer, and the bytes hashed; specializations hash genes in place.
+        \param GeneType - The type of genes
+    */
+    template <typename GeneType>
+    struct genome_hash
+    {
+        //! 64-bit FNV-1a hash of some bytes
+        static uint64_t bytes(const void * a_data, size_t a_length)
+        {
+            const unsigned char * data = static_cast<const unsigned char *>(a_data);
+            uint64_t hash = 14695981039346656037ULL;
+
+            for (size_t n = 0; n < a_length; ++n)
+            {
+                hash ^= data[n];
+                hash *= 1099511628211ULL;
+            }
+
+            return hash;
+        }
+
+        //! Hash genes
+        /*!
+            \param a_genes - The genes
+            \param a_scratch - Reusable buffer
+            \return The hash
+        */
+        static uint64_t hash(const GeneType & a_genes, checkpoint_writer & a_scratch)
+        {
+            a_scratch.data().clear();
+            serializer<GeneType>::write(a_scratch, a_genes);
+            return bytes(a_scratch.data().data(), a_scratch.data().size());
+        }
+    };
+
+    //! Hashes floating-point genes in place
+    template <typename Allocator>
+    struct genome_hash< vector<double, Allocator> >
+    {
+        //! Hash genes
+        static uint64_t hash(const vector<double, Allocator> & a_genes, checkpoint_writer &)
+        {
+            return genome_hash<int>::bytes(a_genes.data(), sizeof(double) * a_genes.size());
+        }
+    };
+
+    //! An analyzer that stops evolution when it stagnates
+    /*!
+        Two signs of stagnation are watched, either of which ends a run:
+        <ul>
+        <li>The fittest <i>top_k</i> genomes are the same for
+            <i>patience</i> generations. Genomes are compared by hash, and
+            the hashes of the top k combined without regard to order, so no
+            organism is copied or compared gene by gene.</li>
+        <li>The best fitness improves by no more than
+            <i>min_improvement</i>, in total, over a sliding window of
+            <i>window</i> generations.</li>
+        </ul>
+        Either test is disabled by setting its length (patience or window)
+        to zero. As with the base analyzer, a nonzero maximum number of
+        iterations also ends a run.
+        \param OrganismType - The type of organism
+    */
+    template <typename OrganismType>
+    class stagnation_analyzer : public analyzer<OrganismType>
+    {
+    public:
+        //! Why a run was stopped
+        enum stop_reason
+        {
+            STOP_NONE,       //!< Not stopped
+            STOP_ITERATIONS, //!< Reached the maximum number of iterations
+            STOP_UNCHANGED,  //!< The fittest genomes didn't change
+            STOP_PLATEAU     //!< The best fitness didn't improve enough
+        };
+
+        //! Creation constructor
+        /*!
+            \param a_listener - A listener for events
+            \param a_max_iterations - Maximum iterations; ignored if zero
+            \param a_top_k - Number of fittest genomes to watch
+            \param a_patience - Generations the fittest genomes may stay the same; zero to disable
+            \param a_window - Generations over which improvement is measured; zero to disable
+            \param a_min_improvement - Least total improvement expected over the window
+        */
+        stagnation_analyzer(listener<OrganismType> & a_listener,
+                            size_t                   a_max_iterations = 0,
+                            size_t                   a_top_k = 1,
+                            size_t                   a_patience = 20,
+                            size_t                   a_window = 0,
+                            double                   a_min_improvement = 0.0)
+          : analyzer<OrganismType>(a_listener, a_max_iterations),
+            m_top_k(a_top_k > 0 ? a_top_k : 1),
+            m_patience(a_patience),
+            m_min_improvement(a_min_improvement),
+            m_signature(0),
+            m_unchanged(0),
+            m_previous_best(0.0),
+            m_have_best(false),
+            m_improvements(a_window, 0.0),
+            m_next(0),
+            m_filled(0),
+            m_reason(STOP_NONE),
+            m_order(),
+            m_scratch()
+        {
+            // nada
+        }
+
+        //! Analyze a population
+        /*!
+            \param a_population - A population of tested organisms
+            \param a_iteration - Iteration count for this report
+            \return <b>true</b> if evolution should continue; <b>false</b> if not
+        */
+        virtual bool analyze(const vector<OrganismType> & a_population, size_t a_iteration)
+        {
+            if (!analyzer<OrganismType>::analyze(a_population, a_iteration))
+            {
+                m_reason = STOP_ITERATIONS;
+                return false;
+            }
+
+            if (a_population.empty())
+                return true;
+
+            // find the fittest k, in no particular order
+            size_t k = std::min(m_top_k, a_population.size());
+            m_order.resize(a_population.size());
+
+            for (size_t n = 0; n < m_order.size(); ++n)
+                m_order[n] = n;
+
+            std::nth_element(m_order.begin(), m_order.begin() + (k - 1), m_order.end(),
+                             [&a_population](size_t a, size_t b) { return a_population[a].fitness > a_population[b].fitness; });
+
+            // a sum of mixed hashes doesn't depend on order
+            uint64_t signature = 0;
+            double best = a_population[m_order[0]].fitness;
+
+            for (size_t n = 0; n < k; ++n)
+            {
+                const OrganismType & organism = a_population[m_order[n]];
+                uint64_t h = genome_hash<decltype(organism.genes)>::hash(organism.genes, m_scratch);
+
+                // splitmix64 finalizer
+                h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+                signature += h ^ (h >> 31);
+
+                best = std::max(best, organism.fitness);
+            }
+
+            if (m_have_best && (signature == m_signature))
+                ++m_unchanged;
+            else
+                m_unchanged = 0;
+
+            m_signature = signature;
+
+            // slide the window of improvements
+            if (!m_improvements.empty() && m_have_best)
+            {
+                m_improvements[m_next] = best - m_previous_best;
+                m_next = (m_next + 1) % m_improvements.size();
+
+                if (m_filled < m_improvements.size())
+                    ++m_filled;
+            }
+
+            m_previous_best = best;
+            m_have_best = true;
+
+            if ((m_patience > 0) && (m_unchanged >= m_patience))
+            {
+                m_reason = STOP_UNCHANGED;
+                return false;
+            }
+
+            if (!m_improvements.empty() && (m_filled == m_improvements.size()))
+            {
+                double total = 0.0;
+
+                for (size_t n = 0; n < m_improvements.size(); ++n)
+                    total += m_improvements[n];
+
+                if (total <= m_min_improvement)
+                {
+                    m_reason = STOP_PLATEAU;
+                    return false;
+                }
+            }
+
+            m_reason = STOP_NONE;
+            return true;
+        }
+
+        //! Get the reason the last analysis stopped evolution
+        stop_reason get_stop_reason() const
+        {
+            return m_reason;
+        }
+
+        //! Get the number of generations the fittest genomes have been unchanged
+        size_t get_unchanged() const
+        {
+            return m_unchanged;
+        }
+
+        //! Write state to a checkpoint
+        virtual void save_state(checkpoint_writer & a_out) const
+        {
+            a_out.put(m_signature);
+            a_out.put_size(m_unchanged);
+            a_out.put(m_previous_best);
+            a_out.put(static_cast<uint8_t>(m_have_best ? 1 : 0));
+            serializer< vector<double> >::write(a_out, m_improvements);
+            a_out.put_size(m_next);
+            a_out.put_size(m_filled);
+        }
+
+        //! Read state from a checkpoint
+        virtual void restore_state(checkpoint_reader & a_in)
+        {
+            m_signature     = a_in.get<uint64_t>();
+            m_unchanged     = a_in.get_size();
+            m_previous_best = a_in.get<double>();
+            m_have_best     = (a_in.get<uint8_t>() != 0);
+
+            vector<double> improvements = serializer< vector<double> >::read(a_in);
+            size_t next   = a_in.get_size();
+            size_t filled = a_in.get_size();
+
+            if ((improvements.size() != m_improvements.size()) || (next > improvements.size()) || (filled > improvements.size()))
+                throw std::runtime_error("checkpoint doesn't match stagnation_analyzer window");
+
+            m_improvements.swap(improvements);
+            m_next   = next;
+            m_filled = filled;
+            m_reason = STOP_NONE;
+        }
+
+    private:
+        // genomes watched
+        size_t m_top_k;
+
+        // generations unchanged before stopping
+        size_t m_patience;
+
+        // least improvement over the window
+        double m_min_improvement;
+
+        // combined hash of the fittest genomes
+        uint64_t m_signature;
+
+        // generations with the same signature
+        size_t m_unchanged;
+
+        // best fitness of the last generation
+        double m_previous_best;
+
+        // has a generation been seen?
+        bool m_have_best;
+
+        // ring of recent improvements
+        vector<double> m_improvements;
+
+        // next slot in the ring
+        size_t m_next;
+
+        // slots used
+        size_t m_filled;
+
+        // why the last analysis stopped
+        stop_reason m_reason;
+
+        // indexes of organisms; kept to avoid reallocation
+        vector<size_t> m_order;
+
+        // buffer for hashing genes
+        checkpoint_writer m_scratch;
+    };
+};
+
+#endif
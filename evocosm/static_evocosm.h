@@ -0,0 +1,301 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_STATIC_EVOCOSM_H)
+#define LIBEVOCOSM_STATIC_EVOCOSM_H
+
+// Standard C++ library
+#include <vector>
+
+// libevocosm
+#include "listener.h"
+#include "organism.h"
+#include "scheduler.h"
+#include "metrics.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! An evocosm whose components are known at compile time
+    /*!
+        Runs the same generation as evocosm, but holds each component by
+        its concrete type rather than through an abstract interface, so
+        calls to them are direct, and the compiler can inline the fitness
+        test of each organism into the loop that tests the population.
+        <p>
+        A component need not derive from anything; it only needs the
+        members that are called:
+        <ul>
+        <li>Landscape: <i>double test(OrganismType &)</i>, called for each organism</li>
+        <li>Mutator: <i>void mutate(vector<OrganismType> &)</i></li>
+        <li>Reproducer: <i>vector<OrganismType> breed(const vector<OrganismType> &, size_t)</i></li>
+        <li>Scaler: <i>void scale_fitness(vector<OrganismType> &)</i></li>
+        <li>Selector: <i>vector<OrganismType> select_survivors(vector<OrganismType> &)</i></li>
+        <li>Analyzer: <i>bool analyze(const vector<OrganismType> &, size_t)</i></li>
+        <li>Listener: the ping_generation_begin, ping_generation_end and
+            run_complete members of listener</li>
+        </ul>
+        The existing components satisfy these, so they can be mixed with
+        static ones. A component that derives from one of the virtual
+        interfaces is still called virtually, unless its class (or the
+        member) is declared <b>final</b>, which lets the compiler call it
+        directly. A landscape's own test of a whole population is not used,
+        since the evocosm tests each organism itself.
+        <p>
+        With static_organism and a fixed-size genotype, nothing in a
+        generation is virtual, and organisms are trivially copyable.
+        \param OrganismType - The type of organism
+        \param Landscape - Tests fitness
+        \param Mutator - Randomly changes genes
+        \param Reproducer - Creates new organisms
+        \param Scaler - Scales fitness
+        \param Selector - Chooses survivors
+        \param Analyzer - Reports on and stops evolution
+        \param Listener - Receives events
+    */
+    template <class OrganismType,
+              class Landscape,
+              class Mutator,
+              class Reproducer,
+              class Scaler,
+              class Selector,
+              class Analyzer,
+              class Listener = listener<OrganismType> >
+    class static_evocosm : protected globals
+    {
+    public:
+        //! Creation constructor
+        /*!
+            The referenced objects must continue to exist during the
+            lifetime of the evocosm.
+            \param a_population - Initial population of organisms
+            \param a_landscape - Tests organism fitness
+            \param a_mutator - Randomly influences genes
+            \param a_reproducer - Creates new organisms
+            \param a_scaler - Scales fitness
+            \param a_selector - Chooses survivors
+            \param a_analyzer - Reports on evolution
+            \param a_listener - A listener for events
+        */
+        static_evocosm(vector<OrganismType> & a_population,
+                       Landscape &            a_landscape,
+                       Mutator &              a_mutator,
+                       Reproducer &           a_reproducer,
+                       Scaler &               a_scaler,
+                       Selector &             a_selector,
+                       Analyzer &             a_analyzer,
+                       Listener &             a_listener)
+          : m_population(a_population),
+            m_landscape(a_landscape),
+            m_mutator(a_mutator),
+            m_reproducer(a_reproducer),
+            m_scaler(a_scaler),
+            m_selector(a_selector),
+            m_analyzer(a_analyzer),
+            m_listener(a_listener),
+            m_iteration(0),
+            m_null_scheduler(),
+            m_scheduler(&m_null_scheduler)
+        {
+            // nada
+        }
+
+        //! Copy constructor
+        /*!
+            The copy shares the source's population and components.
+            \param a_source - The source object
+        */
+        static_evocosm(const static_evocosm & a_source)
+          : m_population(a_source.m_population),
+            m_landscape(a_source.m_landscape),
+            m_mutator(a_source.m_mutator),
+            m_reproducer(a_source.m_reproducer),
+            m_scaler(a_source.m_scaler),
+            m_selector(a_source.m_selector),
+            m_analyzer(a_source.m_analyzer),
+            m_listener(a_source.m_listener),
+            m_iteration(a_source.m_iteration),
+            m_null_scheduler(),
+            m_scheduler((a_source.m_scheduler == &a_source.m_null_scheduler) ? &m_null_scheduler : a_source.m_scheduler)
+        {
+            // nada
+        }
+
+        //! Compute next generation
+        /*!
+            Tests, analyzes, scales, selects, breeds and mutates, in the
+            same order as evocosm::run_generation; the scheduler is asked
+            whether to continue after testing, and at the end. A generation
+            stopped after testing reports no metrics.
+            \return <b>false</b> when evolution should stop
+        */
+        bool run_generation();
+
+        //! Directly view population
+        vector<OrganismType> & get_population()
+        {
+            return m_population;
+        }
+
+        //! Set the scheduler
+        /*!
+            \param a_scheduler - Decides what happens at each yield; must outlive its use
+        */
+        void set_scheduler(scheduler & a_scheduler)
+        {
+            m_scheduler = &a_scheduler;
+        }
+
+        //! Get the number of generations run
+        size_t get_iteration() const
+        {
+            return m_iteration;
+        }
+
+    private:
+        void begin_phase(generation_phase a_phase)
+        {
+#if defined(EVOCOSM_METRICS)
+            m_metrics.begin_phase(a_phase);
+#endif
+        }
+
+        void end_phase(generation_phase a_phase)
+        {
+#if defined(EVOCOSM_METRICS)
+            m_metrics.end_phase(a_phase);
+#endif
+        }
+
+        vector<OrganismType> & m_population;
+        Landscape &            m_landscape;
+        Mutator &              m_mutator;
+        Reproducer &           m_reproducer;
+        Scaler &               m_scaler;
+        Selector &             m_selector;
+        Analyzer &             m_analyzer;
+        Listener &             m_listener;
+        size_t                 m_iteration;
+        null_scheduler         m_null_scheduler;
+        scheduler *            m_scheduler;
+
+#if defined(EVOCOSM_METRICS)
+        metrics_recorder m_metrics;
+#endif
+    };
+
+    //! Create a static_evocosm, deducing the component types
+    template <class OrganismType, class Landscape, class Mutator, class Reproducer, class Scaler, class Selector, class Analyzer, class Listener>
+    inline static_evocosm<OrganismType, Landscape, Mutator, Reproducer, Scaler, Selector, Analyzer, Listener>
+    make_static_evocosm(vector<OrganismType> & a_population,
+                        Landscape &            a_landscape,
+                        Mutator &              a_mutator,
+                        Reproducer &           a_reproducer,
+                        Scaler &               a_scaler,
+                        Selector &             a_selector,
+                        Analyzer &             a_analyzer,
+                        Listener &             a_listener)
+    {
+        return static_evocosm<OrganismType, Landscape, Mutator, Reproducer, Scaler, Selector, Analyzer, Listener>
+                   (a_population, a_landscape, a_mutator, a_reproducer, a_scaler, a_selector, a_analyzer, a_listener);
+    }
+
+    // compute next generation
+    template <class OrganismType, class Landscape, class Mutator, class Reproducer, class Scaler, class Selector, class Analyzer, class Listener>
+    bool static_evocosm<OrganismType, Landscape, Mutator, Reproducer, Scaler, Selector, Analyzer, Listener>::run_generation()
+    {
+        ++m_iteration;
+
+#if defined(EVOCOSM_METRICS)
+        // stops recording however the generation ends
+        generation_recording recording(m_metrics, m_iteration);
+#endif
+
+        m_listener.ping_generation_begin(m_population, m_iteration);
+
+        // check population fitness; a direct call the compiler can inline
+        begin_phase(PHASE_TEST);
+
+        for (size_t n = 0; n < m_population.size(); ++n)
+        {
+#if defined(EVOCOSM_METRICS)
+            uint64_t start = metrics_recorder::now();
+            m_population[n].fitness = m_landscape.test(m_population[n]);
+            metrics_recorder::record_evaluation(metrics_recorder::now() - start);
+#else
+            m_population[n].fitness = m_landscape.test(m_population[n]);
+#endif
+        }
+
+        end_phase(PHASE_TEST);
+
+        if (!m_scheduler->yield())
+            return false;
+
+        begin_phase(PHASE_GENERATION_END);
+        m_listener.ping_generation_end(m_population, m_iteration);
+        end_phase(PHASE_GENERATION_END);
+
+        begin_phase(PHASE_ANALYZE);
+        bool keep_going = m_analyzer.analyze(m_population, m_iteration);
+        end_phase(PHASE_ANALYZE);
+
+        if (keep_going)
+        {
+            begin_phase(PHASE_SCALE);
+            m_scaler.scale_fitness(m_population);
+            end_phase(PHASE_SCALE);
+
+            begin_phase(PHASE_SELECT);
+            vector<OrganismType> survivors = m_selector.select_survivors(m_population);
+            end_phase(PHASE_SELECT);
+
+            begin_phase(PHASE_BREED);
+            g_random.set_stream(m_iteration, 0, STREAM_BREED);
+            vector<OrganismType> children = m_reproducer.breed(m_population, m_population.size() - survivors.size());
+            end_phase(PHASE_BREED);
+
+#if defined(EVOCOSM_METRICS)
+            metrics_recorder::count_children(children.size());
+#endif
+
+            begin_phase(PHASE_MUTATE);
+            g_random.set_stream(m_iteration, 0, STREAM_MUTATE);
+            m_mutator.mutate(children);
+            end_phase(PHASE_MUTATE);
+
+            // survivors become the new population, without copying them again
+            begin_phase(PHASE_TURNOVER);
+            survivors.insert(survivors.end(), children.begin(), children.end());
+            m_population.swap(survivors);
+            end_phase(PHASE_TURNOVER);
+
+            keep_going = m_scheduler->yield();
+        }
+        else
+        {
+            m_listener.run_complete(m_population);
+        }
+
+#if defined(EVOCOSM_METRICS)
+        m_listener.ping_generation_metrics(recording.finish());
+#endif
+
+        return keep_going;
+    }
+};
+
+#endif
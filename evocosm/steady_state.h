@@ -0,0 +1,296 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_STEADY_STATE_H)
+#define LIBEVOCOSM_STEADY_STATE_H
+
+// Standard C++ library
+#include <vector>
+
+// libevocosm
+#include "listener.h"
+#include "organism.h"
+#include "landscape.h"
+#include "mutator.h"
+#include "reproducer.h"
+#include "analyzer.h"
+#include "scheduler.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! A steady-state evocosm
+    /*!
+        An evocosm is generational: it tests an entire population, then
+        replaces much of it at once. A steady_state_evocosm instead breeds a
+        single child, tests it, and puts it into the population in place of a
+        "loser", over and over again. There is no point at which the whole
+        population must wait for its slowest fitness test, and good children
+        become parents immediately.
+        <p>
+        The usual mutator, reproducer, and landscape components work
+        unchanged; each step asks the reproducer for one child, which is
+        mutated and tested alone. Since a reproducer may do per-call setup
+        (such as building a roulette wheel), a reproducer using a
+        tournament_sampler is the best match for steady-state evolution.
+        Fitness scaling and survivor selection do not apply.
+        <p>
+        For the sake of analyzers and listeners, a "generation" is as many
+        births as there are organisms in the population.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class steady_state_evocosm : protected globals
+    {
+    public:
+        //! How a child finds its place in the population
+        enum replacement_policy
+        {
+            REPLACE_WORST,      //!< Replace the least fit organism
+            REPLACE_TOURNAMENT  //!< Replace the least fit of a few organisms chosen at random
+        };
+
+        //! Creation constructor
+        /*!
+            Creates a new steady-state evocosm. As with evocosm, the referenced
+            objects must continue to exist during the lifetime of this object.
+            \param a_population - Initial population of organisms
+            \param a_landscape - Tests organism fitness
+            \param a_mutator - A concrete implementation of mutator
+            \param a_reproducer - A concrete implementation of reproducer
+            \param a_analyzer - A concrete implementation of analyzer
+            \param a_listener - A listener for events
+            \param a_policy - How children replace existing organisms
+            \param a_tournament_size - Organisms in each replacement tournament
+        */
+        steady_state_evocosm(vector<OrganismType> &     a_population,
+                             landscape<OrganismType> &  a_landscape,
+                             mutator<OrganismType> &    a_mutator,
+                             reproducer<OrganismType> & a_reproducer,
+                             analyzer<OrganismType> &   a_analyzer,
+                             listener<OrganismType> &   a_listener,
+                             replacement_policy         a_policy = REPLACE_TOURNAMENT,
+                             size_t                     a_tournament_size = 2)
+          : m_population(a_population),
+            m_landscape(a_landscape),
+            m_mutator(a_mutator),
+            m_reproducer(a_reproducer),
+            m_analyzer(a_analyzer),
+            m_listener(a_listener),
+            m_policy(a_policy),
+            m_tournament_size(a_tournament_size > 0 ? a_tournament_size : 1),
+            m_iteration(0),
+            m_births(0),
+            m_tested(false),
+            m_null_scheduler(),
+            m_scheduler(&m_null_scheduler)
+        {
+            // nada
+        }
+
+        //! Virtual destructor
+        /*!
+            A virtual destructor. By default, it does nothing; this is
+            a placeholder that identifies this class as a potential base,
+            ensuring that objects of a derived class will have their
+            destructors called if they are destroyed through a base-class
+            pointer.
+        */
+        virtual ~steady_state_evocosm()
+        {
+            // nada
+        }
+
+        //! Breed, test, and insert a single child
+        /*!
+            The unit of work in a steady-state algorithm. The first call
+            tests the initial population, with the landscape's test of a
+            whole population; a landscape that spreads that over threads
+            (such as stealing_landscape) keeps them busy from the start.
+        */
+        virtual void run_step();
+
+        //! Run one generation's worth of births
+        /*!
+            Performs as many steps as there are organisms, then asks the
+            analyzer whether to continue. Returns <i>false</i> at once if the
+            scheduler stops evolution.
+            \return Returns <i>true</i> while evolution should continue.
+        */
+        virtual bool run_generation();
+
+        //! Directly view population
+        /*! <b>Use with caution!</b> This function provides direct read-write
+            access to the population.
+        */
+        vector<OrganismType> & get_population()
+        {
+            return m_population;
+        }
+
+        //! Get the number of children born so far
+        size_t get_births() const
+        {
+            return m_births;
+        }
+
+        //! Set the scheduler
+        /*!
+            Sets the object consulted after each step, which may pause,
+            throttle, or stop evolution. The scheduler must continue to exist
+            during the lifetime of the evocosm, or until it is replaced.
+            \param a_scheduler - The new scheduler
+        */
+        void set_scheduler(scheduler & a_scheduler)
+        {
+            m_scheduler = &a_scheduler;
+        }
+
+    protected:
+        //! Chooses the organism to be replaced by a new child
+        /*!
+            \return Index of the loser
+        */
+        virtual size_t choose_loser();
+
+        //! The population of organisms
+        vector<OrganismType> & m_population;
+
+        //! Tests organism fitness
+        landscape<OrganismType> & m_landscape;
+
+        //! A mutator to randomly influence genes
+        mutator<OrganismType> & m_mutator;
+
+        //! Creates new organisms
+        reproducer<OrganismType> & m_reproducer;
+
+        //! Decides when evolution is done
+        analyzer<OrganismType> & m_analyzer;
+
+        //! A listener for progress
+        listener<OrganismType> & m_listener;
+
+        //! Replacement policy
+        replacement_policy m_policy;
+
+        //! Organisms per replacement tournament
+        size_t m_tournament_size;
+
+        //! Count of generations completed
+        size_t m_iteration;
+
+        //! Count of children born
+        size_t m_births;
+
+        //! Has the initial population been tested?
+        bool m_tested;
+
+        //! Default scheduler, used until another is set
+        null_scheduler m_null_scheduler;
+
+        //! Consulted after each step
+        scheduler * m_scheduler;
+    };
+
+    // choose an organism to replace
+    template <class OrganismType>
+    size_t steady_state_evocosm<OrganismType>::choose_loser()
+    {
+        size_t loser = 0;
+
+        if (m_policy == REPLACE_WORST)
+        {
+            for (size_t n = 1; n < m_population.size(); ++n)
+            {
+                if (m_population[n].fitness < m_population[loser].fitness)
+                    loser = n;
+            }
+        }
+        else
+        {
+            g_random.set_stream(m_births, 0, STREAM_SELECT);
+            loser = g_random.get_index(m_population.size());
+
+            for (size_t n = 1; n < m_tournament_size; ++n)
+            {
+                size_t challenger = g_random.get_index(m_population.size());
+
+                if (m_population[challenger].fitness < m_population[loser].fitness)
+                    loser = challenger;
+            }
+        }
+
+        return loser;
+    }
+
+    // breed, test, and insert one child
+    template <class OrganismType>
+    void steady_state_evocosm<OrganismType>::run_step()
+    {
+        // the initial population needs fitness values before anyone can breed
+        if (!m_tested)
+        {
+            m_landscape.test(m_population);
+            m_tested = true;
+        }
+
+        // each birth takes the place of a generation in the stream key, leaving
+        // the organism part to operators that key their draws per child
+        g_random.set_stream(m_births, 0, STREAM_BREED);
+        vector<OrganismType> children = m_reproducer.breed(m_population, 1);
+
+        if (children.empty())
+            return;
+
+        g_random.set_stream(m_births, 0, STREAM_MUTATE);
+        m_mutator.mutate(children);
+
+        children[0].fitness = m_landscape.test(children[0]);
+
+        m_population[choose_loser()] = children[0];
+
+        ++m_births;
+    }
+
+    // a generation's worth of births
+    template <class OrganismType>
+    bool steady_state_evocosm<OrganismType>::run_generation()
+    {
+        ++m_iteration;
+
+        m_listener.ping_generation_begin(m_population, m_iteration);
+
+        for (size_t n = 0; n < m_population.size(); ++n)
+        {
+            run_step();
+
+            if (!m_scheduler->yield())
+                return false;
+        }
+
+        m_listener.ping_generation_end(m_population, m_iteration);
+
+        bool keep_going = m_analyzer.analyze(m_population, m_iteration);
+
+        if (!keep_going)
+            m_listener.run_complete(m_population);
+
+        return keep_going;
+    }
+};
+
+#endif
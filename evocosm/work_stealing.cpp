@@ -0,0 +1,447 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <stdexcept>
+
+#include "work_stealing.h"
+using namespace libevocosm;
+
+// pool whose loop the current thread is running, if any
+static thread_local const work_stealing_pool * t_running = NULL;
+
+// pack a range
+static inline uint64_t pack(size_t a_first, size_t a_last)
+{
+    return (static_cast<uint64_t>(a_first) << 32) | static_cast<uint64_t>(a_last);
+}
+
+// unpack a range
+static inline void unpack(uint64_t a_range, size_t & a_first, size_t & a_last)
+{
+    a_first = static_cast<size_t>(a_range >> 32);
+    a_last  = static_cast<size_t>(a_range & 0xFFFFFFFFULL);
+}
+
+// add a range at the bottom
+bool range_deque::push(size_t a_first, size_t a_last)
+{
+    int64_t b = m_bottom.load(std::memory_order_relaxed);
+    int64_t t = m_top.load(std::memory_order_acquire);
+
+    if (b - t >= static_cast<int64_t>(CAPACITY))
+        return false;
+
+    m_ranges[b % CAPACITY].store(pack(a_first, a_last), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+// remove the newest range
+bool range_deque::take(size_t & a_first, size_t & a_last)
+{
+    int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = m_top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        // empty
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t range = m_ranges[b % CAPACITY].load(std::memory_order_relaxed);
+    bool result = true;
+
+    if (t == b)
+    {
+        // the last range; a thief may want it too
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            result = false;
+
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    if (result)
+        unpack(range, a_first, a_last);
+
+    return result;
+}
+
+// remove the oldest range
+bool range_deque::steal(size_t & a_first, size_t & a_last)
+{
+    int64_t t = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = m_bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return false;
+
+    uint64_t range = m_ranges[t % CAPACITY].load(std::memory_order_relaxed);
+
+    if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return false;
+
+    unpack(range, a_first, a_last);
+    return true;
+}
+
+// a thread's slot
+work_stealing_pool::slot::slot()
+  : m_deque(),
+    m_shard(0),
+    m_tasks(0),
+    m_items(0),
+    m_steals(0),
+    m_failed_steals(0),
+    m_idle_ns(0),
+    m_busy_ns(0),
+    m_victims()
+{
+    // nada
+}
+
+// constructor
+work_stealing_pool::work_stealing_pool(size_t a_threads, bool a_bind_nodes)
+  : m_slots(),
+    m_threads(),
+    m_bind_nodes(false),
+    m_run(NULL),
+    m_body(NULL),
+    m_grain(1),
+    m_random(),
+    m_epoch(0),
+    m_open(false),
+    m_stop(false),
+    m_remaining(0),
+    m_active(0),
+    m_failed(false),
+    m_error()
+{
+    if (a_threads == 0)
+        a_threads = std::thread::hardware_concurrency();
+
+    if (a_threads == 0)
+        a_threads = 1;
+
+    for (size_t n = 0; n < a_threads; ++n)
+        m_slots.push_back(new slot);
+
+    m_bind_nodes = a_bind_nodes && numa_topology::host().is_numa() && (a_threads > 1);
+
+    // each thread steals from the threads after it, on its own node first; unbound, all share a node
+    for (size_t n = 0; n < a_threads; ++n)
+    {
+        size_t node = m_bind_nodes ? get_node(n) : 0;
+
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            for (size_t k = 1; k < a_threads; ++k)
+            {
+                size_t victim = (n + k) % a_threads;
+                bool local = !m_bind_nodes || (get_node(victim) == node);
+
+                if (local == (pass == 0))
+                    m_slots[n]->m_victims.push_back(victim);
+            }
+        }
+    }
+
+    for (size_t n = 1; n < a_threads; ++n)
+        m_threads.push_back(std::thread(&work_stealing_pool::thread_main, this, n));
+}
+
+// destructor
+work_stealing_pool::~work_stealing_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stop = true;
+    }
+
+    m_wake.notify_all();
+
+    for (size_t n = 0; n < m_threads.size(); ++n)
+        m_threads[n].join();
+
+    for (size_t n = 0; n < m_slots.size(); ++n)
+        delete m_slots[n];
+}
+
+// run a loop
+void work_stealing_pool::run(size_t a_count, size_t a_grain, t_run * a_run, void * a_body)
+{
+    if (a_count == 0)
+        return;
+
+    if (a_count > 0xFFFFFFFFULL)
+        throw std::runtime_error("work_stealing_pool: too many iterations in one loop");
+
+    // a loop inside a loop, or a pool with nobody to help, runs here
+    if ((t_running == this) || (m_slots.size() == 1))
+    {
+        prng random = g_random;
+        uint64_t start = metrics_recorder::now();
+        a_run(a_body, 0, a_count);
+
+        // the surrounding range is counted by the loop it belongs to
+        if (t_running != this)
+        {
+            m_slots[0]->m_tasks.fetch_add(1, std::memory_order_relaxed);
+            m_slots[0]->m_items.fetch_add(a_count, std::memory_order_relaxed);
+            m_slots[0]->m_busy_ns.fetch_add(metrics_recorder::now() - start, std::memory_order_relaxed);
+        }
+
+        g_random = random;
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(m_run_lock);
+
+    m_remaining.store(a_count, std::memory_order_relaxed);
+    m_failed.store(false, std::memory_order_relaxed);
+    m_error = std::exception_ptr();
+
+    // a contiguous shard for each thread; empty shards are left unset
+    for (size_t n = 0; n < m_slots.size(); ++n)
+    {
+        size_t first = a_count * n / m_slots.size();
+        size_t last  = a_count * (n + 1) / m_slots.size();
+        m_slots[n]->m_shard.store((first < last) ? pack(first, last) : 0, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_run    = a_run;
+        m_body   = a_body;
+        m_grain  = (a_grain > 0) ? a_grain : 1;
+        m_random = g_random;
+        m_open   = true;
+        ++m_epoch;
+    }
+
+    m_wake.notify_all();
+
+    const work_stealing_pool * outer = t_running;
+    t_running = this;
+    work(0);
+    t_running = outer;
+
+    // a thread that wakes late must not join the next loop with this one's generator
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_open = false;
+    }
+
+    while (m_active.load(std::memory_order_acquire) > 0)
+        std::this_thread::yield();
+
+    // every thread ran the loop from the same generator state
+    g_random = m_random;
+
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+// work until the loop is finished
+void work_stealing_pool::work(size_t a_slot)
+{
+    slot & mine = *m_slots[a_slot];
+    uint64_t idle_start = 0;
+
+    while (m_remaining.load(std::memory_order_acquire) > 0)
+    {
+        size_t first, last;
+        bool found = mine.m_deque.take(first, last) || claim(a_slot, first, last);
+
+        // look through the other threads' deques and shards, nearest first
+        for (size_t n = 0; !found && (n < mine.m_victims.size()); ++n)
+        {
+            size_t victim = mine.m_victims[n];
+            found = m_slots[victim]->m_deque.steal(first, last) || claim(victim, first, last);
+
+            if (found)
+                mine.m_steals.fetch_add(1, std::memory_order_relaxed);
+            else
+                mine.m_failed_steals.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (found)
+        {
+            if (idle_start != 0)
+            {
+                mine.m_idle_ns.fetch_add(metrics_recorder::now() - idle_start, std::memory_order_relaxed);
+                idle_start = 0;
+            }
+
+            run_range(a_slot, first, last);
+        }
+        else
+        {
+            if (idle_start == 0)
+                idle_start = metrics_recorder::now();
+
+            std::this_thread::yield();
+        }
+    }
+
+    if (idle_start != 0)
+        mine.m_idle_ns.fetch_add(metrics_recorder::now() - idle_start, std::memory_order_relaxed);
+}
+
+// take a thread's shard
+bool work_stealing_pool::claim(size_t a_slot, size_t & a_first, size_t & a_last)
+{
+    std::atomic<uint64_t> & shard = m_slots[a_slot]->m_shard;
+
+    // look before writing, so threads don't fight over a cache line with nothing in it
+    if (shard.load(std::memory_order_relaxed) == 0)
+        return false;
+
+    uint64_t range = shard.exchange(0, std::memory_order_acquire);
+
+    if (range == 0)
+        return false;
+
+    unpack(range, a_first, a_last);
+    return true;
+}
+
+// split a range, then run the rest
+void work_stealing_pool::run_range(size_t a_slot, size_t a_first, size_t a_last)
+{
+    slot & mine = *m_slots[a_slot];
+
+    // leave upper halves for thieves; the deque only fills if ranges are absurdly large
+    while (a_last - a_first > m_grain)
+    {
+        size_t middle = a_first + (a_last - a_first) / 2;
+
+        if (!mine.m_deque.push(middle, a_last))
+            break;
+
+        a_last = middle;
+    }
+
+    uint64_t start = metrics_recorder::now();
+
+    if (!m_failed.load(std::memory_order_relaxed))
+    {
+        try
+        {
+            m_run(m_body, a_first, a_last);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_error_lock);
+
+            if (!m_error)
+                m_error = std::current_exception();
+
+            m_failed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    mine.m_busy_ns.fetch_add(metrics_recorder::now() - start, std::memory_order_relaxed);
+    mine.m_tasks.fetch_add(1, std::memory_order_relaxed);
+    mine.m_items.fetch_add(a_last - a_first, std::memory_order_relaxed);
+
+    // the caller may return as soon as this reaches zero
+    m_remaining.fetch_sub(a_last - a_first, std::memory_order_acq_rel);
+}
+
+// a pool thread
+void work_stealing_pool::thread_main(size_t a_slot)
+{
+    size_t seen = 0;
+
+    // loops started by bodies run on this thread alone
+    t_running = this;
+
+    if (m_bind_nodes)
+        numa_topology::host().bind_thread(get_node(a_slot));
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+            m_wake.wait(lock, [&] { return m_stop || (m_open && (m_epoch != seen)); });
+
+            if (m_stop)
+                return;
+
+            seen = m_epoch;
+            g_random = m_random;
+            m_active.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        work(a_slot);
+        m_active.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+// statistics of each thread
+vector<work_stealing_stats> work_stealing_pool::get_stats() const
+{
+    vector<work_stealing_stats> result(m_slots.size());
+
+    for (size_t n = 0; n < m_slots.size(); ++n)
+    {
+        result[n].tasks         = m_slots[n]->m_tasks.load(std::memory_order_relaxed);
+        result[n].items         = m_slots[n]->m_items.load(std::memory_order_relaxed);
+        result[n].steals        = m_slots[n]->m_steals.load(std::memory_order_relaxed);
+        result[n].failed_steals = m_slots[n]->m_failed_steals.load(std::memory_order_relaxed);
+        result[n].idle_ns       = m_slots[n]->m_idle_ns.load(std::memory_order_relaxed);
+        result[n].busy_ns       = m_slots[n]->m_busy_ns.load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+// statistics of all threads
+work_stealing_stats work_stealing_pool::get_total_stats() const
+{
+    vector<work_stealing_stats> each = get_stats();
+    work_stealing_stats result = { 0, 0, 0, 0, 0, 0 };
+
+    for (size_t n = 0; n < each.size(); ++n)
+    {
+        result.tasks         += each[n].tasks;
+        result.items         += each[n].items;
+        result.steals        += each[n].steals;
+        result.failed_steals += each[n].failed_steals;
+        result.idle_ns       += each[n].idle_ns;
+        result.busy_ns       += each[n].busy_ns;
+    }
+
+    return result;
+}
+
+// zero statistics
+void work_stealing_pool::reset_stats()
+{
+    for (size_t n = 0; n < m_slots.size(); ++n)
+    {
+        m_slots[n]->m_tasks.store(0, std::memory_order_relaxed);
+        m_slots[n]->m_items.store(0, std::memory_order_relaxed);
+        m_slots[n]->m_steals.store(0, std::memory_order_relaxed);
+        m_slots[n]->m_failed_steals.store(0, std::memory_order_relaxed);
+        m_slots[n]->m_idle_ns.store(0, std::memory_order_relaxed);
+        m_slots[n]->m_busy_ns.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,436 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(LIBEVOCOSM_WORK_STEALING_H)
+#define LIBEVOCOSM_WORK_STEALING_H
+
+// Standard C++ Library
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// libevocosm
+#include "evocommon.h"
+#include "listener.h"
+#include "landscape.h"
+#include "metrics.h"
+#include "numa_topology.h"
+
+namespace libevocosm
+{
+    using std::vector;
+
+    //! A Chase-Lev work-stealing deque of index ranges
+    /*!
+        The owning thread pushes and takes ranges at the bottom, like a
+        stack; other threads steal from the top, taking the oldest (and, as
+        work_stealing_pool splits them, largest) range. Owner operations
+        cost no atomic read-modify-write except when taking the last range;
+        a steal costs one compare-and-swap.
+        <p>
+        A range is packed into one 64-bit word, so ranges are limited to
+        indexes below 2<sup>32</sup>. The deque does not grow: a pool that
+        splits ranges in half never holds more than one range per bit of
+        the index, so CAPACITY is ample.
+    */
+    class range_deque
+    {
+    public:
+        //! Most ranges the deque can hold
+        static const size_t CAPACITY = 64;
+
+        //! Constructor
+        range_deque()
+          : m_top(0),
+            m_bottom(0)
+        {
+            for (size_t n = 0; n < CAPACITY; ++n)
+                m_ranges[n].store(0, std::memory_order_relaxed);
+        }
+
+        //! Add a range at the bottom; owner only
+        /*!
+            \param a_first - First index
+            \param a_last - One past the last index
+            \return <b>false</b> if the deque is full
+        */
+        bool push(size_t a_first, size_t a_last);
+
+        //! Remove the newest range; owner only
+        /*!
+            \param a_first - Receives the first index
+            \param a_last - Receives one past the last index
+            \return <b>false</b> if the deque is empty
+        */
+        bool take(size_t & a_first, size_t & a_last);
+
+        //! Remove the oldest range; any thread
+        /*!
+            Fails when the deque is empty, or when another thread took the
+            same range first.
+            \param a_first - Receives the first index
+            \param a_last - Receives one past the last index
+            \return <b>false</b> if nothing was stolen
+        */
+        bool steal(size_t & a_first, size_t & a_last);
+
+    private:
+        // not copyable
+        range_deque(const range_deque &);
+        range_deque & operator = (const range_deque &);
+
+        // ranges, as (first << 32) | last
+        std::atomic<uint64_t> m_ranges[CAPACITY];
+
+        // next range to steal; padded away from the owner's end, since
+        // deques are allocated on the heap, where alignas can't be relied on
+        char m_pad1[64];
+        std::atomic<int64_t> m_top;
+
+        // next free slot
+        char m_pad2[64];
+        std::atomic<int64_t> m_bottom;
+        char m_pad3[64];
+    };
+
+    //! Scheduling statistics for one thread of a work_stealing_pool
+    struct work_stealing_stats
+    {
+        //! Ranges run
+        uint64_t tasks;
+
+        //! Indexes run
+        uint64_t items;
+
+        //! Ranges stolen from other threads
+        uint64_t steals;
+
+        //! Attempts to steal that found nothing
+        uint64_t failed_steals;
+
+        //! Time spent looking for work while a job had work left, in ns
+        uint64_t idle_ns;
+
+        //! Time spent running ranges, in ns
+        uint64_t busy_ns;
+    };
+
+    //! Runs loops on a set of threads that balance work by stealing it
+    /*!
+        Splitting a loop into one equal chunk per thread balances badly when
+        iterations differ in cost: finite state machines of different sizes,
+        or simulations that end early. Each thread of a work_stealing_pool
+        has a range_deque. A loop starts with one contiguous shard of the
+        index range set aside for each thread; a thread holding a range
+        splits it in half, leaving the upper half in its deque where idle
+        threads can steal it, until the range is no bigger than the grain.
+        A thread with nothing left steals from the others' deques, or
+        claims a whole shard whose owner has not yet started it. Expensive
+        iterations leave their thread busy while the others take the
+        remaining halves.
+        <p>
+        On a multi-socket host, a pool constructed to bind its threads
+        assigns them to NUMA nodes in contiguous blocks, so thread i runs on
+        node i * nodes / threads, and indexes near each other are run on
+        the same node. A thread looks for work on its own node's threads
+        before stealing from another node. The calling thread is not bound;
+        it counts as thread zero, on node zero.
+        <p>
+        The thread that calls parallel_for works as one of the pool's
+        threads, so a pool of <i>N</i> threads starts <i>N</i> - 1 more.
+        Loops are run one at a time; a loop started from inside a loop's
+        body runs on the calling thread alone.
+        <p>
+        Each thread starts a loop with a copy of the caller's g_random, and
+        the caller's generator is restored when the loop ends. A body that
+        keys the generator to its index (prng::set_organism) draws the same
+        values whichever thread runs it, so results do not depend on the
+        number of threads; a body that does not will repeat values drawn on
+        other threads.
+        <p>
+        Threads wait on a condition variable between loops, and spin,
+        yielding, while a loop has work left; the time spent spinning is
+        reported as idle time.
+    */
+    class work_stealing_pool : protected globals
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_threads - Threads that run loops, including the caller; zero means one per hardware thread
+            \param a_bind_nodes - <b>true</b> to bind the pool's threads to NUMA nodes
+        */
+        work_stealing_pool(size_t a_threads = 0, bool a_bind_nodes = false);
+
+        //! Destructor
+        /*!
+            Stops and joins the threads.
+        */
+        ~work_stealing_pool();
+
+        //! Run a loop
+        /*!
+            Calls a_body(i) for every i in [0, a_count), spread across the
+            pool's threads, and returns when all calls have finished. If a
+            call throws, iterations not yet started are skipped, and the
+            first exception is rethrown here.
+            \param a_count - Number of iterations; must be less than 2<sup>32</sup>
+            \param a_body - Function object called with each index
+            \param a_grain - Largest range run without splitting it further
+        */
+        template <typename Body>
+        void parallel_for(size_t a_count, Body & a_body, size_t a_grain = 1)
+        {
+            run(a_count, a_grain, &call_body<Body>, &a_body);
+        }
+
+        //! Get the number of threads, including the caller's
+        size_t get_threads() const
+        {
+            return m_slots.size();
+        }
+
+        //! Are the pool's threads bound to NUMA nodes?
+        /*!
+            \return <b>false</b> if binding was not asked for, or the host has one node
+        */
+        bool get_node_binding() const
+        {
+            return m_bind_nodes;
+        }
+
+        //! Get the node a thread runs on when bound
+        /*!
+            \param a_thread - Index of a thread; zero is the caller's
+            \return Index of its node in numa_topology::host()
+        */
+        size_t get_node(size_t a_thread) const
+        {
+            return a_thread * numa_topology::host().node_count() / m_slots.size();
+        }
+
+        //! Get the statistics of each thread
+        /*!
+            Element zero belongs to the threads that called parallel_for;
+            the others to the pool's own threads.
+            \return Statistics since construction or the last reset_stats
+        */
+        vector<work_stealing_stats> get_stats() const;
+
+        //! Get the statistics of all threads, summed
+        work_stealing_stats get_total_stats() const;
+
+        //! Zero the statistics
+        void reset_stats();
+
+    private:
+        // not copyable
+        work_stealing_pool(const work_stealing_pool &);
+        work_stealing_pool & operator = (const work_stealing_pool &);
+
+        // runs a range of a loop
+        typedef void t_run(void * a_body, size_t a_first, size_t a_last);
+
+        // calls a function object for a range of indexes
+        template <typename Body>
+        static void call_body(void * a_body, size_t a_first, size_t a_last)
+        {
+            Body & body = *static_cast<Body *>(a_body);
+
+            for (size_t n = a_first; n < a_last; ++n)
+                body(n);
+        }
+
+        // a thread's deque and statistics, padded onto their own cache lines
+        struct slot
+        {
+            range_deque m_deque;
+            std::atomic<uint64_t> m_shard;
+            std::atomic<uint64_t> m_tasks;
+            std::atomic<uint64_t> m_items;
+            std::atomic<uint64_t> m_steals;
+            std::atomic<uint64_t> m_failed_steals;
+            std::atomic<uint64_t> m_idle_ns;
+            std::atomic<uint64_t> m_busy_ns;
+
+            // other threads, in the order this one steals from them
+            vector<size_t> m_victims;
+
+            char m_pad[64];
+
+            slot();
+        };
+
+        // run a loop with a type-erased body
+        void run(size_t a_count, size_t a_grain, t_run * a_run, void * a_body);
+
+        // work on the current loop until it is finished
+        void work(size_t a_slot);
+
+        // take a thread's shard if nobody has yet
+        bool claim(size_t a_slot, size_t & a_first, size_t & a_last);
+
+        // split a range, then run what is left of it
+        void run_range(size_t a_slot, size_t a_first, size_t a_last);
+
+        // body of a pool thread
+        void thread_main(size_t a_slot);
+
+        // one per thread; slot zero is the caller's
+        vector<slot *> m_slots;
+
+        // the pool's own threads
+        vector<std::thread> m_threads;
+
+        // are the pool's threads bound to nodes?
+        bool m_bind_nodes;
+
+        // one loop at a time
+        std::mutex m_run_lock;
+
+        // guards the loop description, epoch and stop flag
+        std::mutex m_lock;
+        std::condition_variable m_wake;
+
+        // the current loop
+        t_run * m_run;
+        void * m_body;
+        size_t m_grain;
+        prng m_random;
+        size_t m_epoch;
+        bool m_open;
+        bool m_stop;
+
+        // iterations not yet finished
+        char m_pad[64];
+        std::atomic<size_t> m_remaining;
+
+        // pool threads working on the current loop
+        std::atomic<size_t> m_active;
+
+        // set when a body threw
+        std::atomic<bool> m_failed;
+        std::mutex m_error_lock;
+        std::exception_ptr m_error;
+    };
+
+    //! A landscape that tests a population on a work_stealing_pool
+    /*!
+        Wraps another landscape, and calls its test of a single organism for
+        each member of a population, on the pool's threads. The wrapped
+        landscape's test must be safe to call from several threads at once
+        on different organisms.
+        <p>
+        When the pool's threads are bound to NUMA nodes, the thread testing
+        an organism first copies its genes, so they are placed in the memory
+        of the node that tests them; the same shard of the population goes
+        to the same node in each generation. That costs one copy of the
+        genes per test, which pays when tests outweigh copying.
+        \param OrganismType - The type of organism
+    */
+    template <class OrganismType>
+    class stealing_landscape : public landscape<OrganismType>
+    {
+    public:
+        //! Creation constructor
+        /*!
+            \param a_listener - A listener for events
+            \param a_landscape - Tests single organisms; must outlive this object
+            \param a_pool - Runs the tests; must outlive this object
+        */
+        stealing_landscape(listener<OrganismType> & a_listener, const landscape<OrganismType> & a_landscape, work_stealing_pool & a_pool)
+          : landscape<OrganismType>(a_listener),
+            m_landscape(a_landscape),
+            m_pool(a_pool)
+        {
+            // nada
+        }
+
+        //! Performs fitness testing
+        /*!
+            \param a_organism - The organism to be tested
+            \param a_verbose - Display verbose information for test
+            \return Computed fitness for this organism
+        */
+        virtual double test(OrganismType & a_organism, bool a_verbose = false) const
+        {
+            return m_landscape.test(a_organism, a_verbose);
+        }
+
+        //! Performs fitness testing
+        /*!
+            Tests every organism, one pool iteration each.
+            \param a_population - Organisms to be tested
+            \return Zero, as for the base class
+        */
+        virtual double test(vector<OrganismType> & a_population) const
+        {
+#if defined(EVOCOSM_METRICS)
+            // only the caller's thread has a recorder, so times are recorded afterward
+            vector<uint64_t> times(a_population.size());
+
+            auto body = [&] (size_t n)
+            {
+                uint64_t start = metrics_recorder::now();
+
+                if (m_pool.get_node_binding())
+                    localize(a_population[n]);
+
+                a_population[n].fitness = m_landscape.test(a_population[n]);
+                times[n] = metrics_recorder::now() - start;
+            };
+
+            m_pool.parallel_for(a_population.size(), body);
+
+            for (size_t n = 0; n < times.size(); ++n)
+                metrics_recorder::record_evaluation(times[n]);
+#else
+            auto body = [&] (size_t n)
+            {
+                if (m_pool.get_node_binding())
+                    localize(a_population[n]);
+
+                a_population[n].fitness = m_landscape.test(a_population[n]);
+            };
+
+            m_pool.parallel_for(a_population.size(), body);
+#endif
+
+            return 0.0;
+        }
+
+    private:
+        // move an organism's genes into memory first touched by this thread
+        static void localize(OrganismType & a_organism)
+        {
+            decltype(a_organism.genes) local(a_organism.genes);
+            std::swap(a_organism.genes, local);
+        }
+
+        // tests single organisms
+        const landscape<OrganismType> & m_landscape;
+
+        // runs the tests
+        work_stealing_pool & m_pool;
+    };
+};
+
+#endif
@@ -0,0 +1,84 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#include <cstdlib>
+#include <new>
+
+#include "../../evocosm/metrics.h"
+#include "alloc_hook.h"
+using namespace libevocosm;
+
+// allocations made by each thread
+static thread_local uint64_t g_allocations = 0;
+
+uint64_t allocation_count()
+{
+    return g_allocations;
+}
+
+void * operator new(size_t a_size)
+{
+    ++g_allocations;
+    metrics_recorder::count_allocation();
+
+    void * result = malloc(a_size > 0 ? a_size : 1);
+
+    if (result == NULL)
+        throw std::bad_alloc();
+
+    return result;
+}
+
+void * operator new[](size_t a_size)
+{
+    return operator new(a_size);
+}
+
+void * operator new(size_t a_size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return operator new(a_size);
+    }
+    catch (std::bad_alloc &)
+    {
+        return NULL;
+    }
+}
+
+void * operator new[](size_t a_size, const std::nothrow_t &) noexcept
+{
+    return operator new(a_size, std::nothrow);
+}
+
+void operator delete(void * a_ptr) noexcept
+{
+    free(a_ptr);
+}
+
+void operator delete[](void * a_ptr) noexcept
+{
+    free(a_ptr);
+}
+
+void operator delete(void * a_ptr, size_t) noexcept
+{
+    free(a_ptr);
+}
+
+void operator delete[](void * a_ptr, size_t) noexcept
+{
+    free(a_ptr);
+}
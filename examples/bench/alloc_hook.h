@@ -0,0 +1,30 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(ALLOC_HOOK_H)
+#define ALLOC_HOOK_H
+
+#include <cstdint>
+
+// Linking alloc_hook.cpp into a program replaces the global operator new
+// with one that counts every heap allocation, per thread, and reports it
+// to metrics_recorder::count_allocation; an evocosm built with
+// EVOCOSM_METRICS then fills in generation_metrics::allocations and
+// phase_allocations. Only the benchmark programs link it.
+
+// number of heap allocations made by the calling thread
+uint64_t allocation_count();
+
+#endif
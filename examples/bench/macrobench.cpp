@@ -0,0 +1,543 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+// Standard C++
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Evocosm
+#include "../../evocosm/function_optimizer.h"
+#include "../../evocosm/command_line.h"
+using namespace libevocosm;
+
+// prisoner's dilemma strategies
+#include "../pdsm/pdsm.h"
+
+// counts allocations
+#include "alloc_hook.h"
+
+// end-to-end throughput of whole evolutionary runs
+//
+//     macrobench [-threads 1,2,4] [-generations 100] [-seed 1] [-output file]
+//                [-dimensions 2,10,100,1000] [-population 100]
+//                [-pdsm-population 32,64] [-pdsm-states 4,16] [-pdsm-rounds 16,64]
+//
+// Each case runs function_optimizer's components on a standard test
+// function, or pdsm's on the prisoner's dilemma, for a fixed number of
+// generations. With several threads, each runs its own copy of the case
+// from its own seed (seed + thread), so work scales with the threads and
+// efficiency shows how well throughput does, relative to one thread.
+// Threads default to powers of two up to every core; a one-thread run is
+// always made, first, as the baseline for efficiency. Results are written as JSON, to standard output
+// unless a file is named; per-phase times and allocations appear when
+// Evocosm is configured with --enable-metrics.
+
+// seeds the calling thread's generator
+class bench_random : protected globals
+{
+public:
+    static void seed(unsigned long long int a_seed)
+    {
+        g_random.set_seed(a_seed);
+    }
+};
+
+// holds threads until all are ready, so setup isn't timed
+class start_gate
+{
+public:
+    start_gate(size_t a_count)
+      : m_waiting(a_count)
+    {
+        // nada
+    }
+
+    void wait()
+    {
+        unique_lock<mutex> lock(m_lock);
+
+        if (--m_waiting == 0)
+            m_ready.notify_all();
+        else
+            m_ready.wait(lock, [this] { return m_waiting == 0; });
+    }
+
+private:
+    mutex m_lock;
+    condition_variable m_ready;
+    size_t m_waiting;
+};
+
+// one thread's share of a case
+struct thread_totals
+{
+    uint64_t start;
+    uint64_t end;
+    size_t generations;
+    uint64_t evaluations;
+    uint64_t allocations;
+    uint64_t phase_ns[PHASE_COUNT];
+    uint64_t phase_allocations[PHASE_COUNT];
+};
+
+// adds up per-generation metrics
+template <typename OrganismType>
+class totals_listener : public null_listener<OrganismType>
+{
+public:
+    totals_listener(thread_totals & a_totals)
+      : m_totals(a_totals)
+    {
+        // nada
+    }
+
+    virtual void ping_generation_metrics(const generation_metrics & a_metrics)
+    {
+        for (size_t p = 0; p < PHASE_COUNT; ++p)
+        {
+            m_totals.phase_ns[p] += a_metrics.phase_ns[p];
+            m_totals.phase_allocations[p] += a_metrics.phase_allocations[p];
+        }
+    }
+
+private:
+    thread_totals & m_totals;
+};
+
+// run an evocosm for a number of generations, once every thread is ready
+template <typename OrganismType>
+static void timed_run(evocosm<OrganismType> & a_evocosm, size_t a_population, size_t a_generations, start_gate & a_gate, thread_totals & a_totals)
+{
+    a_evocosm.set_sleep_time(0);
+    a_gate.wait();
+
+    uint64_t allocations = allocation_count();
+    a_totals.start = metrics_recorder::now();
+
+    while ((a_totals.generations < a_generations) && a_evocosm.run_generation())
+        ++a_totals.generations;
+
+    a_totals.end = metrics_recorder::now();
+    a_totals.allocations = allocation_count() - allocations;
+
+    // every organism is tested once per generation
+    a_totals.evaluations = a_totals.generations * a_population;
+}
+
+// function optimization
+
+double const PI = 3.1415926535897932384626433832795028841971694;
+
+// fitness rises toward one as a minimization function approaches zero
+static vector<double> minimized(double a_value)
+{
+    vector<double> result;
+    result.push_back(a_value);
+    result.push_back(1.0 / (1.0 + a_value));
+    return result;
+}
+
+static vector<double> rastrigin(vector<double> a_args)
+{
+    double f = 10.0 * a_args.size();
+
+    for (size_t n = 0; n < a_args.size(); ++n)
+        f += a_args[n] * a_args[n] - 10.0 * cos(2.0 * PI * a_args[n]);
+
+    return minimized(f);
+}
+
+static vector<double> rosenbrock(vector<double> a_args)
+{
+    double f = 0.0;
+
+    for (size_t n = 0; n + 1 < a_args.size(); ++n)
+    {
+        double a = a_args[n + 1] - a_args[n] * a_args[n];
+        double b = 1.0 - a_args[n];
+        f += 100.0 * a * a + b * b;
+    }
+
+    return minimized(f);
+}
+
+static vector<double> ackley(vector<double> a_args)
+{
+    double squares = 0.0;
+    double cosines = 0.0;
+
+    for (size_t n = 0; n < a_args.size(); ++n)
+    {
+        squares += a_args[n] * a_args[n];
+        cosines += cos(2.0 * PI * a_args[n]);
+    }
+
+    double d = static_cast<double>(a_args.size());
+    double f = -20.0 * exp(-0.2 * sqrt(squares / d)) - exp(cosines / d) + 20.0 + exp(1.0);
+
+    return minimized(f);
+}
+
+// type of function_landscape's fitness function
+typedef vector<double> t_test_function(vector<double> a_args);
+
+// a test function and its usual domain
+struct test_function
+{
+    const char * name;
+    t_test_function * function;
+    double minarg;
+    double maxarg;
+};
+
+static const test_function g_functions[] =
+{
+    { "rastrigin",  &rastrigin,  -5.12,   5.12   },
+    { "rosenbrock", &rosenbrock, -2.048,  2.048  },
+    { "ackley",     &ackley,     -32.768, 32.768 }
+};
+
+// one thread of a function optimization case
+static void run_fopt(const test_function & a_function, size_t a_dimensions, size_t a_population, size_t a_generations,
+                     unsigned long long int a_seed, start_gate & a_gate, thread_totals & a_totals)
+{
+    bench_random::seed(a_seed);
+
+    // the same components as function_optimizer, without its output
+    totals_listener<function_solution> listener(a_totals);
+    vector<function_solution> population;
+
+    for (size_t n = 0; n < a_population; ++n)
+        population.push_back(function_solution((int)a_dimensions, a_function.minarg, a_function.maxarg));
+
+    function_landscape                    landscape(a_function.function, listener);
+    function_mutator                      mutator(0.25);
+    function_reproducer                   reproducer(1.0);
+    linear_norm_scaler<function_solution> scaler;
+    elitism_selector<function_solution>   selector(0.90);
+    analyzer<function_solution>           analyzer(listener);
+
+    evocosm<function_solution> cosm(population, landscape, mutator, reproducer, scaler, selector, analyzer, listener);
+    timed_run(cosm, a_population, a_generations, a_gate, a_totals);
+}
+
+// prisoner's dilemma
+
+static void run_pdsm(size_t a_population, size_t a_states, size_t a_rounds, size_t a_generations,
+                     unsigned long long int a_seed, start_gate & a_gate, thread_totals & a_totals)
+{
+    bench_random::seed(a_seed);
+
+    // pdsm's default configuration
+    totals_listener<pdsm_strategy> listener(a_totals);
+    vector<pdsm_strategy> population;
+
+    for (size_t n = 0; n < a_population; ++n)
+        population.push_back(pdsm_strategy(simple_machine<2,2>(a_states)));
+
+    roulette_sampler<pdsm_strategy>   sampler;
+    pdsm_landscape                    landscape(listener, a_rounds);
+    pdsm_mutator                      mutator(0.25);
+    pdsm_reproducer                   reproducer(sampler, 1.0);
+    linear_norm_scaler<pdsm_strategy> scaler;
+    elitism_selector<pdsm_strategy>   selector(0.5);
+    analyzer<pdsm_strategy>           analyzer(listener);
+
+    evocosm<pdsm_strategy> cosm(population, landscape, mutator, reproducer, scaler, selector, analyzer, listener);
+    timed_run(cosm, a_population, a_generations, a_gate, a_totals);
+}
+
+// measurement and reporting
+
+// a measured case
+struct result
+{
+    string workload;
+    string parameters;
+    size_t threads;
+    double seconds;
+    double generations_per_second;
+    double evaluations_per_second;
+    double efficiency;
+    double allocations_per_generation;
+    uint64_t phase_ns[PHASE_COUNT];
+    uint64_t phase_allocations[PHASE_COUNT];
+};
+
+static vector<result> g_results;
+
+// throughput of the case on one thread, for efficiency
+static double g_single_rate = 0.0;
+
+// run a case on some threads; a_case(seed, gate, totals) runs one copy
+template <typename Case>
+static void measure(const string & a_workload, const string & a_parameters, size_t a_threads, unsigned long long int a_seed, Case a_case)
+{
+    vector<thread_totals> totals(a_threads);
+    start_gate gate(a_threads);
+    vector<thread> threads;
+
+    for (size_t t = 0; t < a_threads; ++t)
+    {
+        thread_totals & mine = totals[t];
+        memset(&mine, 0, sizeof(thread_totals));
+        threads.push_back(thread([&, t] { a_case(a_seed + t, gate, mine); }));
+    }
+
+    for (size_t t = 0; t < a_threads; ++t)
+        threads[t].join();
+
+    // wall time from the first start to the last finish
+    result r;
+    r.workload   = a_workload;
+    r.parameters = a_parameters;
+    r.threads    = a_threads;
+
+    uint64_t start = totals[0].start;
+    uint64_t end   = totals[0].end;
+    size_t generations = 0;
+    uint64_t evaluations = 0;
+    uint64_t allocations = 0;
+
+    for (size_t p = 0; p < PHASE_COUNT; ++p)
+    {
+        r.phase_ns[p] = 0;
+        r.phase_allocations[p] = 0;
+    }
+
+    for (size_t t = 0; t < a_threads; ++t)
+    {
+        start = min(start, totals[t].start);
+        end   = max(end, totals[t].end);
+        generations += totals[t].generations;
+        evaluations += totals[t].evaluations;
+        allocations += totals[t].allocations;
+
+        for (size_t p = 0; p < PHASE_COUNT; ++p)
+        {
+            r.phase_ns[p] += totals[t].phase_ns[p];
+            r.phase_allocations[p] += totals[t].phase_allocations[p];
+        }
+    }
+
+    r.seconds = (end > start) ? double(end - start) / 1.0e9 : 1.0e-9;
+    r.generations_per_second = double(generations) / r.seconds;
+    r.evaluations_per_second = double(evaluations) / r.seconds;
+    r.allocations_per_generation = (generations > 0) ? double(allocations) / double(generations) : 0.0;
+
+    if (a_threads == 1)
+        g_single_rate = r.generations_per_second;
+
+    r.efficiency = (g_single_rate > 0.0) ? r.generations_per_second / (double(a_threads) * g_single_rate) : 0.0;
+
+    g_results.push_back(r);
+    fprintf(stderr, "%-6s %-40s %3zu threads %12.1f gen/s %14.1f eval/s %6.2f efficiency\n",
+            a_workload.c_str(), a_parameters.c_str(), a_threads, r.generations_per_second, r.evaluations_per_second, r.efficiency);
+}
+
+// parse a comma-separated list of sizes
+static vector<size_t> parse_sizes(const string & a_text)
+{
+    vector<size_t> result;
+    size_t pos = 0;
+
+    while (pos < a_text.size())
+    {
+        size_t comma = a_text.find(',', pos);
+
+        if (comma == string::npos)
+            comma = a_text.size();
+
+        size_t value = (size_t)atol(a_text.substr(pos, comma - pos).c_str());
+
+        if (value > 0)
+            result.push_back(value);
+
+        pos = comma + 1;
+    }
+
+    return result;
+}
+
+// write results as JSON
+static void write_json(FILE * a_out, size_t a_generations, unsigned long long int a_seed)
+{
+#if defined(EVOCOSM_METRICS)
+    bool phases = true;
+#else
+    bool phases = false;
+#endif
+
+    fprintf(a_out, "{\n  \"hardware_threads\": %u,\n  \"generations\": %zu,\n  \"seed\": %llu,\n  \"phases\": %s,\n  \"results\": [\n",
+            thread::hardware_concurrency(), a_generations, a_seed, phases ? "true" : "false");
+
+    for (size_t n = 0; n < g_results.size(); ++n)
+    {
+        const result & r = g_results[n];
+
+        fprintf(a_out, "    { \"workload\": \"%s\", %s, \"threads\": %zu, \"seconds\": %.6f, \"generations_per_second\": %.3f, \"evaluations_per_second\": %.3f, \"efficiency\": %.4f, \"allocations_per_generation\": %.1f",
+                r.workload.c_str(), r.parameters.c_str(), r.threads, r.seconds, r.generations_per_second, r.evaluations_per_second, r.efficiency, r.allocations_per_generation);
+
+        if (phases)
+        {
+            fprintf(a_out, ",\n      \"phase_ns\": {");
+
+            for (size_t p = 0; p < PHASE_COUNT; ++p)
+                fprintf(a_out, " \"%s\": %llu%s", generation_metrics::phase_name(generation_phase(p)), (unsigned long long)r.phase_ns[p], (p + 1 < PHASE_COUNT) ? "," : "");
+
+            fprintf(a_out, " },\n      \"phase_allocations\": {");
+
+            for (size_t p = 0; p < PHASE_COUNT; ++p)
+                fprintf(a_out, " \"%s\": %llu%s", generation_metrics::phase_name(generation_phase(p)), (unsigned long long)r.phase_allocations[p], (p + 1 < PHASE_COUNT) ? "," : "");
+
+            fprintf(a_out, " }");
+        }
+
+        fprintf(a_out, " }%s\n", (n + 1 < g_results.size()) ? "," : "");
+    }
+
+    fprintf(a_out, "  ]\n}\n");
+}
+
+int main(int argc, char * argv[])
+{
+    size_t cores = max(1u, thread::hardware_concurrency());
+    vector<size_t> thread_counts;
+
+    for (size_t t = 1; t < cores; t *= 2)
+        thread_counts.push_back(t);
+
+    thread_counts.push_back(cores);
+
+    size_t generations = 100;
+    unsigned long long int seed = 1;
+    vector<size_t> dimensions = parse_sizes("2,10,100,1000");
+    size_t population = 100;
+    vector<size_t> pdsm_populations = parse_sizes("32,64");
+    vector<size_t> pdsm_states = parse_sizes("4,16");
+    vector<size_t> pdsm_rounds = parse_sizes("16,64");
+    string output_file;
+
+    // parse arguments
+    set<string> bool_options; // empty list
+    command_line args(argc,argv,bool_options);
+
+    for (vector<command_line::option>::const_iterator opt = args.get_options().begin(); opt != args.get_options().end(); ++opt)
+    {
+        if (opt->m_name == "threads")
+            thread_counts = parse_sizes(opt->m_value);
+        else if (opt->m_name == "generations")
+            generations = max((size_t)1, (size_t)atol(opt->m_value.c_str()));
+        else if (opt->m_name == "seed")
+            seed = strtoull(opt->m_value.c_str(), NULL, 10);
+        else if (opt->m_name == "dimensions")
+            dimensions = parse_sizes(opt->m_value);
+        else if (opt->m_name == "population")
+            population = max((size_t)2, (size_t)atol(opt->m_value.c_str()));
+        else if (opt->m_name == "pdsm-population")
+            pdsm_populations = parse_sizes(opt->m_value);
+        else if (opt->m_name == "pdsm-states")
+            pdsm_states = parse_sizes(opt->m_value);
+        else if (opt->m_name == "pdsm-rounds")
+            pdsm_rounds = parse_sizes(opt->m_value);
+        else if (opt->m_name == "output")
+            output_file = opt->m_value;
+    }
+
+    // efficiency is relative to one thread, so that case runs first, whether or not it was asked for
+    thread_counts.erase(remove(thread_counts.begin(), thread_counts.end(), (size_t)0), thread_counts.end());
+    thread_counts.push_back(1);
+    sort(thread_counts.begin(), thread_counts.end());
+    thread_counts.erase(unique(thread_counts.begin(), thread_counts.end()), thread_counts.end());
+
+    char parameters[128];
+
+    // function optimization
+    for (size_t f = 0; f < sizeof(g_functions) / sizeof(g_functions[0]); ++f)
+    {
+        for (size_t d = 0; d < dimensions.size(); ++d)
+        {
+            const test_function & function = g_functions[f];
+            size_t dims = dimensions[d];
+
+            snprintf(parameters, sizeof(parameters), "\"function\": \"%s\", \"dimensions\": %zu, \"population\": %zu", function.name, dims, population);
+            g_single_rate = 0.0;
+
+            for (size_t t = 0; t < thread_counts.size(); ++t)
+            {
+                measure("fopt", parameters, thread_counts[t], seed, [&](unsigned long long int a_seed, start_gate & a_gate, thread_totals & a_totals)
+                {
+                    run_fopt(function, dims, population, generations, a_seed, a_gate, a_totals);
+                });
+            }
+        }
+    }
+
+    // prisoner's dilemma
+    for (size_t p = 0; p < pdsm_populations.size(); ++p)
+    {
+        for (size_t s = 0; s < pdsm_states.size(); ++s)
+        {
+            for (size_t r = 0; r < pdsm_rounds.size(); ++r)
+            {
+                size_t pop    = max((size_t)2, pdsm_populations[p]);
+                size_t states = max((size_t)2, pdsm_states[s]);
+                size_t rounds = pdsm_rounds[r];
+
+                snprintf(parameters, sizeof(parameters), "\"population\": %zu, \"states\": %zu, \"rounds\": %zu", pop, states, rounds);
+                g_single_rate = 0.0;
+
+                for (size_t t = 0; t < thread_counts.size(); ++t)
+                {
+                    measure("pdsm", parameters, thread_counts[t], seed, [&](unsigned long long int a_seed, start_gate & a_gate, thread_totals & a_totals)
+                    {
+                        run_pdsm(pop, states, rounds, generations, a_seed, a_gate, a_totals);
+                    });
+                }
+            }
+        }
+    }
+
+    // report
+    FILE * output = stdout;
+
+    if (!output_file.empty())
+    {
+        output = fopen(output_file.c_str(), "w");
+
+        if (output == NULL)
+        {
+            fprintf(stderr, "macrobench: unable to create %s\n", output_file.c_str());
+            return 1;
+        }
+    }
+
+    write_json(output, generations, seed);
+
+    if (output != stdout)
+        fclose(output);
+
+    return 0;
+}
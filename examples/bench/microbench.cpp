@@ -0,0 +1,405 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+// Standard C++
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Evocosm
+#include "../../evocosm/evocommon.h"
+#include "../../evocosm/evoreal.h"
+#include "../../evocosm/roulette.h"
+#include "../../evocosm/organism.h"
+#include "../../evocosm/stats.h"
+#include "../../evocosm/scaler.h"
+#include "../../evocosm/selector.h"
+#include "../../evocosm/simple_machine.h"
+#include "../../evocosm/metrics.h"
+#include "../../evocosm/command_line.h"
+using namespace libevocosm;
+
+// counts allocations
+#include "alloc_hook.h"
+
+// micro-benchmarks of core primitives
+//
+//     microbench [-sizes 10,100,1000,10000] [-states 2,16,128] [-time 0.1] [-output file]
+//
+// sizes are population sizes, states are machine sizes, and time is the
+// least number of seconds to spend on each case; results are written as
+// JSON, to standard output unless a file is named
+//
+// Operations that should never touch the heap once warmed up have an
+// allocation budget of zero; if any exceeds its budget, the program says
+// so and exits with status 1, so "make bench" catches the regression
+
+// keeps results from being optimized away
+static volatile double g_sink = 0.0;
+
+// a measurement
+struct result
+{
+    string name;
+    const char * parameter;
+    size_t size;
+    size_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+    double budget;
+};
+
+// no allocation budget
+static const double NO_BUDGET = -1.0;
+
+// number of operations over budget
+static size_t g_over_budget = 0;
+
+static vector<result> g_results;
+
+// least time per case, in ns
+static uint64_t g_min_ns = 100000000ULL;
+
+// time an operation, doubling the iterations until enough time has passed
+template <typename Operation>
+static void measure(const string & a_name, const char * a_parameter, size_t a_size, double a_budget, Operation a_op)
+{
+    // warm up caches and lazily-built tables
+    a_op();
+
+    size_t iterations = 1;
+
+    while (true)
+    {
+        uint64_t allocations = allocation_count();
+        uint64_t start = metrics_recorder::now();
+
+        for (size_t n = 0; n < iterations; ++n)
+            a_op();
+
+        uint64_t elapsed = metrics_recorder::now() - start;
+        allocations = allocation_count() - allocations;
+
+        if ((elapsed >= g_min_ns) || (iterations >= (size_t(1) << 40)))
+        {
+            result r = { a_name, a_parameter, a_size, iterations,
+                         double(elapsed) / double(iterations),
+                         double(allocations) / double(iterations),
+                         a_budget };
+            g_results.push_back(r);
+            fprintf(stderr, "%-28s %-10s %8zu %12.1f ns/op %10.2f allocs/op\n", a_name.c_str(), a_parameter, a_size, r.ns_per_op, r.allocs_per_op);
+
+            if ((a_budget >= 0.0) && (r.allocs_per_op > a_budget))
+            {
+                fprintf(stderr, "microbench: %s (%s %zu) made %.2f allocations per operation; its budget is %.2f\n",
+                        a_name.c_str(), a_parameter, a_size, r.allocs_per_op, a_budget);
+                ++g_over_budget;
+            }
+
+            return;
+        }
+
+        iterations *= 2;
+    }
+}
+
+// parse a comma-separated list of sizes
+static vector<size_t> parse_sizes(const string & a_text)
+{
+    vector<size_t> result;
+    size_t pos = 0;
+
+    while (pos < a_text.size())
+    {
+        size_t comma = a_text.find(',', pos);
+
+        if (comma == string::npos)
+            comma = a_text.size();
+
+        size_t value = (size_t)atol(a_text.substr(pos, comma - pos).c_str());
+
+        if (value > 0)
+            result.push_back(value);
+
+        pos = comma + 1;
+    }
+
+    return result;
+}
+
+typedef organism< vector<double> > real_organism;
+
+// a population with random fitness
+static vector<real_organism> make_population(prng & a_random, size_t a_size)
+{
+    vector<real_organism> population(a_size, real_organism(vector<double>(8, 0.0)));
+
+    for (size_t n = 0; n < a_size; ++n)
+    {
+        for (size_t g = 0; g < population[n].genes.size(); ++g)
+            population[n].genes[g] = a_random.get_real();
+
+        population[n].fitness = 1.0 + a_random.get_real();
+    }
+
+    return population;
+}
+
+// time a scaler; each operation restores the original fitness first
+static void measure_scaler(const string & a_name, scaler<real_organism> & a_scaler, vector<real_organism> & a_population, const vector<double> & a_fitness)
+{
+    measure("scaler." + a_name, "population", a_population.size(), 0.0, [&]()
+    {
+        for (size_t n = 0; n < a_population.size(); ++n)
+            a_population[n].fitness = a_fitness[n];
+
+        a_scaler.scale_fitness(a_population);
+        g_sink = a_population[0].fitness;
+    });
+}
+
+// time a scaler's structure-of-arrays path; each operation restores the original values first
+static void measure_scaler_values(const string & a_name, buffered_scaler<real_organism> & a_scaler, vector<double> & a_values, const vector<double> & a_fitness)
+{
+    measure("scaler." + a_name + ".values", "population", a_values.size(), 0.0, [&]()
+    {
+        std::copy(a_fitness.begin(), a_fitness.end(), a_values.begin());
+        a_scaler.scale_values(&a_values[0], a_values.size());
+        g_sink = a_values[0];
+    });
+}
+
+template <class Engine>
+static void bench_engine(const string & a_name)
+{
+    basic_prng<Engine> random(1);
+    vector<double> reals(1024);
+
+    measure("prng." + a_name + ".next", "none", 0, 0.0, [&]() { g_sink = (double)random.next(); });
+    measure("prng." + a_name + ".get_real", "none", 0, 0.0, [&]() { g_sink = random.get_real(); });
+    measure("prng." + a_name + ".get_index", "none", 0, 0.0, [&]() { g_sink = (double)random.get_index(1000); });
+    measure("prng." + a_name + ".fill", "count", reals.size(), 0.0, [&]() { random.fill(&reals[0], reals.size()); g_sink = reals[0]; });
+
+    // an operator's pattern: key the stream to an organism, then draw once per gene
+    for (size_t draws = 8; draws <= 64; draws *= 8)
+    {
+        unsigned long long int organism = 0;
+
+        measure("prng." + a_name + ".keyed", "draws", draws, 0.0, [&]()
+        {
+            random.set_organism(organism++);
+            double sum = 0.0;
+
+            for (size_t n = 0; n < draws; ++n)
+                sum += random.get_real();
+
+            g_sink = sum;
+        });
+    }
+}
+
+static void bench_prng()
+{
+    bench_engine<kiss_engine>("kiss");
+    bench_engine<xoshiro256_engine>("xoshiro256");
+#if defined(__SIZEOF_INT128__)
+    bench_engine<pcg64_engine>("pcg64");
+#endif
+    bench_engine<philox_engine>("philox");
+}
+
+static void bench_evoreal()
+{
+    evoreal real;
+    double d = 1.0;
+
+    measure("evoreal.mutate", "none", 0, 0.0, [&]() { d = real.mutate(d); if (d != d) d = 1.0; g_sink = d; });
+    measure("evoreal.crossover", "none", 0, 0.0, [&]() { g_sink = real.crossover(1.5, -2.25); });
+}
+
+static void bench_population(size_t a_size)
+{
+    prng random(a_size);
+    vector<real_organism> population = make_population(random, a_size);
+    vector<double> fitness(a_size);
+
+    for (size_t n = 0; n < a_size; ++n)
+        fitness[n] = population[n].fitness;
+
+    // roulette wheel
+    measure("roulette_wheel.construct", "population", a_size, NO_BUDGET, [&]()
+    {
+        roulette_wheel wheel(fitness);
+        g_sink = wheel.get_weight(0);
+    });
+
+    roulette_wheel wheel(fitness);
+    measure("roulette_wheel.get_index", "population", a_size, 0.0, [&]() { g_sink = (double)wheel.get_index(); });
+
+    // statistics
+    measure("fitness_stats.construct", "population", a_size, NO_BUDGET, [&]()
+    {
+        fitness_stats<real_organism> stats(population);
+        g_sink = stats.getMean();
+    });
+
+    // scalers
+    null_scaler<real_organism>        null_s;
+    linear_norm_scaler<real_organism> linear_s;
+    windowed_scaler<real_organism>    windowed_s;
+    exponential_scaler<real_organism> exponential_s;
+    quadratic_scaler<real_organism>   quadratic_s(0.0, 1.0, 0.0);
+    sigma_scaler<real_organism>       sigma_s;
+
+    measure_scaler("null", null_s, population, fitness);
+    measure_scaler("linear_norm", linear_s, population, fitness);
+    measure_scaler("windowed", windowed_s, population, fitness);
+    measure_scaler("exponential", exponential_s, population, fitness);
+    measure_scaler("quadratic", quadratic_s, population, fitness);
+    measure_scaler("sigma", sigma_s, population, fitness);
+
+    // the same scalers on a contiguous array of fitness values
+    vector<double> values(a_size);
+
+    measure_scaler_values("null", null_s, values, fitness);
+    measure_scaler_values("linear_norm", linear_s, values, fitness);
+    measure_scaler_values("windowed", windowed_s, values, fitness);
+    measure_scaler_values("exponential", exponential_s, values, fitness);
+    measure_scaler_values("quadratic", quadratic_s, values, fitness);
+    measure_scaler_values("sigma", sigma_s, values, fitness);
+
+    for (size_t n = 0; n < a_size; ++n)
+        population[n].fitness = fitness[n];
+
+    // selection
+    elitism_selector<real_organism> elitism(0.9);
+
+    measure("elitism_selector.select", "population", a_size, NO_BUDGET, [&]()
+    {
+        vector<real_organism> survivors = elitism.select_survivors(population);
+        g_sink = (double)survivors.size();
+    });
+}
+
+static void bench_machine(size_t a_states)
+{
+    typedef simple_machine<2,2> machine;
+
+    machine parent1(a_states);
+    machine parent2(a_states);
+
+    measure("simple_machine.copy", "states", a_states, NO_BUDGET, [&]()
+    {
+        machine copy(parent1);
+        g_sink = (double)copy.size();
+    });
+
+    measure("simple_machine.crossover", "states", a_states, NO_BUDGET, [&]()
+    {
+        machine child(parent1, parent2);
+        g_sink = (double)child.size();
+    });
+
+    machine mutant(parent1);
+    measure("simple_machine.mutate", "states", a_states, NO_BUDGET, [&]() { mutant.mutate(0.25); });
+
+    machine runner(parent1);
+    size_t input = 0;
+    measure("simple_machine.transition", "states", a_states, 0.0, [&]() { input = runner.transition(input & 1); g_sink = (double)input; });
+}
+
+// write results as JSON
+static void write_json(FILE * a_out)
+{
+    fprintf(a_out, "{\n  \"min_time_ns\": %llu,\n  \"results\": [\n", (unsigned long long)g_min_ns);
+
+    for (size_t n = 0; n < g_results.size(); ++n)
+    {
+        const result & r = g_results[n];
+
+        fprintf(a_out, "    { \"name\": \"%s\", \"parameter\": \"%s\", \"size\": %zu, \"iterations\": %zu, \"ns_per_op\": %.3f, \"allocs_per_op\": %.4f",
+                r.name.c_str(), r.parameter, r.size, r.iterations, r.ns_per_op, r.allocs_per_op);
+
+        if (r.budget >= 0.0)
+            fprintf(a_out, ", \"alloc_budget\": %.4f, \"within_budget\": %s", r.budget, (r.allocs_per_op <= r.budget) ? "true" : "false");
+
+        fprintf(a_out, " }%s\n", (n + 1 < g_results.size()) ? "," : "");
+    }
+
+    fprintf(a_out, "  ]\n}\n");
+}
+
+int main(int argc, char * argv[])
+{
+    vector<size_t> sizes  = parse_sizes("10,100,1000,10000");
+    vector<size_t> states = parse_sizes("2,16,128");
+    string output_file;
+
+    // parse arguments
+    set<string> bool_options; // empty list
+    command_line args(argc,argv,bool_options);
+
+    for (vector<command_line::option>::const_iterator opt = args.get_options().begin(); opt != args.get_options().end(); ++opt)
+    {
+        if (opt->m_name == "sizes")
+            sizes = parse_sizes(opt->m_value);
+        else if (opt->m_name == "states")
+            states = parse_sizes(opt->m_value);
+        else if (opt->m_name == "time")
+        {
+            double seconds = atof(opt->m_value.c_str());
+
+            if (seconds > 0.0)
+                g_min_ns = (uint64_t)(seconds * 1.0e9);
+        }
+        else if (opt->m_name == "output")
+            output_file = opt->m_value;
+    }
+
+    // benchmarks
+    bench_prng();
+    bench_evoreal();
+
+    for (size_t n = 0; n < sizes.size(); ++n)
+        bench_population(sizes[n]);
+
+    for (size_t n = 0; n < states.size(); ++n)
+        bench_machine(states[n]);
+
+    // report
+    FILE * output = stdout;
+
+    if (!output_file.empty())
+    {
+        output = fopen(output_file.c_str(), "w");
+
+        if (output == NULL)
+        {
+            fprintf(stderr, "microbench: unable to create %s\n", output_file.c_str());
+            return 1;
+        }
+    }
+
+    write_json(output);
+
+    if (output != stdout)
+        fclose(output);
+
+    return (g_over_budget == 0) ? 0 : 1;
+}
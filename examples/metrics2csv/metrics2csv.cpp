@@ -0,0 +1,87 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+// Standard C++
+#include <cstdio>
+#include <vector>
+using namespace std;
+
+// Metrics files
+#include "../../evocosm/metrics_sink.h"
+using namespace libevocosm;
+
+// converts a binary metrics file, as written by metrics_sink, to CSV
+//
+//     metrics2csv input [output]
+//
+// with no output file, CSV goes to standard output
+int main(int argc, char * argv[])
+{
+    if ((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: metrics2csv input [output]\n");
+        return 1;
+    }
+
+    FILE * input = fopen(argv[1], "rb");
+
+    if (input == NULL)
+    {
+        fprintf(stderr, "metrics2csv: unable to open %s\n", argv[1]);
+        return 1;
+    }
+
+    if (!metrics_sink::read_header(input))
+    {
+        fprintf(stderr, "metrics2csv: %s is not a metrics file from this version of Evocosm\n", argv[1]);
+        fclose(input);
+        return 1;
+    }
+
+    FILE * output = stdout;
+
+    if (argc == 3)
+    {
+        output = fopen(argv[2], "w");
+
+        if (output == NULL)
+        {
+            fprintf(stderr, "metrics2csv: unable to create %s\n", argv[2]);
+            fclose(input);
+            return 1;
+        }
+    }
+
+    metrics_sink::write_csv_header(output);
+
+    metrics_record record;
+    size_t count = 0;
+
+    while (fread(&record, sizeof(record), 1, input) == 1)
+    {
+        metrics_sink::write_csv(output, record);
+        ++count;
+    }
+
+    fclose(input);
+
+    if (output != stdout)
+    {
+        fclose(output);
+        fprintf(stderr, "metrics2csv: %lu records\n", static_cast<unsigned long>(count));
+    }
+
+    return 0;
+}
@@ -0,0 +1,303 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+#if !defined(PDSM_H)
+#define PDSM_H
+
+// Standard C++
+#include <iostream>
+using namespace std;
+
+// other elements of Evocosm
+#include "../../evocosm/evocosm.h"
+#include "../../evocosm/simple_machine.h"
+#include "../../evocosm/work_stealing.h"
+using namespace libevocosm;
+
+// strategies for the iterated prisoner's dilemma, and the components
+// that evolve them; shared with the benchmark harness
+
+typedef organism< simple_machine<2,2> > pdsm_strategy;
+
+// Stream output operator
+inline ostream & operator << (ostream & strm, const pdsm_strategy & strategy)
+{
+    static string choices[] = { "C", "D" };
+
+    strm << "initial state: " << strategy.genes.init_state() << endl;
+
+    for (size_t s = 0; s < strategy.genes.size(); ++s)
+    {
+        strm << "state " << s << endl;
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const typename simple_machine<2, 2>::tranout_t & tran = strategy.genes.get_transition(s,i);
+
+            strm << "  in "       << choices[i]
+                    << " -> "     << tran.m_new_state
+                    << ", out = " << choices[tran.m_output]
+                    << endl;
+        }
+    }
+
+    return strm;
+}
+
+class pdsm_mutator : public mutator<pdsm_strategy>
+{
+public:
+    pdsm_mutator(double a_mutation_rate)
+        : m_mutation_rate(a_mutation_rate)
+    {
+        // adjust mutation rate if necessary
+        if (m_mutation_rate > 1.0)
+            m_mutation_rate = 1.0;
+        else if (m_mutation_rate < 0.0)
+            m_mutation_rate = 0.0;
+    }
+
+    pdsm_mutator(const pdsm_mutator & a_source)
+        : m_mutation_rate(a_source.m_mutation_rate)
+    {
+        // nada
+    }
+
+    virtual ~pdsm_mutator()
+    {
+        // nada
+    }
+
+    pdsm_mutator & operator = (const pdsm_mutator & a_source)
+    {
+        m_mutation_rate = a_source.m_mutation_rate;
+        return *this;
+    }
+
+    double mutation_rate() const
+    {
+        return m_mutation_rate;
+    }
+
+    void mutate(vector<pdsm_strategy> & a_population)
+    {
+        for (size_t i = 0; i < a_population.size(); ++i)
+            a_population[i].genes.mutate(m_mutation_rate);
+    }
+
+private:
+    // rate of mutation
+    double m_mutation_rate;
+};
+
+class pdsm_reproducer : public reproducer<pdsm_strategy>
+{
+public:
+    pdsm_reproducer(parent_sampler<pdsm_strategy> & a_sampler, double p_crossover_rate = 1.0)
+        : m_crossover_rate(p_crossover_rate),
+          m_sampler(a_sampler)
+    {
+        // adjust crossover rate if necessary
+        if (m_crossover_rate > 1.0)
+            m_crossover_rate = 1.0;
+        else if (m_crossover_rate < 0.0)
+            m_crossover_rate = 0.0;
+    }
+
+    pdsm_reproducer(const pdsm_reproducer & a_source)
+        : m_crossover_rate(a_source.m_crossover_rate),
+          m_sampler(a_source.m_sampler)
+    {
+        // nada
+    }
+
+    virtual ~pdsm_reproducer()
+    {
+        // nada
+    }
+
+    pdsm_reproducer & operator = (const pdsm_reproducer & a_source)
+    {
+        m_crossover_rate = a_source.m_crossover_rate;
+        return *this;
+    }
+
+    double crossover_rate() const
+    {
+        return m_crossover_rate;
+    }
+
+    virtual vector<pdsm_strategy> breed(const vector<pdsm_strategy> & a_population, size_t a_limit)
+    {
+        // prepare to pick parents
+        m_sampler.prepare(a_population);
+
+        // create children
+        vector<pdsm_strategy> children;
+
+        while (a_limit > 0)
+        {
+            // clone an existing organism as a child
+            size_t p1 = m_sampler.pick(a_population);
+
+            // do we crossover?
+            if (g_random.get_real() < m_crossover_rate)
+            {
+                // select a second parent
+                size_t p2 = p1;
+
+                while (p2 == p1)
+                    p2 = m_sampler.pick(a_population);
+
+                children.push_back(pdsm_strategy(simple_machine<2,2>(a_population[p1].genes, a_population[p2].genes)));
+            }
+            else
+                children.push_back(pdsm_strategy(a_population[p1].genes));
+
+            // one down, more to go?
+            --a_limit;
+        }
+
+        // outa here!
+        return children;
+    }
+
+private:
+    // crossover chance
+    double m_crossover_rate;
+
+    // picks parents
+    parent_sampler<pdsm_strategy> & m_sampler;
+};
+
+class pdsm_landscape : public landscape<pdsm_strategy>
+{
+private:
+    // number of rounds played in each contest
+    size_t m_rounds;
+
+    // plays the pairings; NULL plays them here
+    work_stealing_pool * m_pool;
+
+public:
+    pdsm_landscape(listener<pdsm_strategy> & a_listener, size_t a_rounds, work_stealing_pool * a_pool = NULL)
+        : landscape<pdsm_strategy>(a_listener),
+        m_rounds(a_rounds > 0 ? a_rounds : 1),
+        m_pool(a_pool)
+    {
+        // nada
+    }
+
+    pdsm_landscape(const pdsm_landscape & a_source)
+        : landscape<pdsm_strategy>(a_source),
+          m_rounds(a_source.m_rounds),
+          m_pool(a_source.m_pool)
+    {
+        // nada
+    }
+
+    pdsm_landscape & operator = (const pdsm_landscape & a_source)
+    {
+        landscape<pdsm_strategy>::operator = (a_source);
+        m_rounds = a_source.m_rounds;
+        m_pool = a_source.m_pool;
+        return *this;
+    }
+
+    ~pdsm_landscape()
+    {
+        // nada
+    }
+
+    virtual double test(pdsm_strategy & a_organism, bool a_verbose = false) const
+    {
+        // this function is merely a placeholder; it is never called
+        return a_organism.fitness;
+    }
+
+    virtual double test(vector<pdsm_strategy> & a_population) const
+    {
+        static const double P = 1.0; // punishment for mutual defection
+        static const double R = 3.0; // reward for mutual cooperation
+        static const double S = 0.0; // sucker's payoff (you lose)
+        static const double T = 5.0; // temptation to defect
+
+        static const double payout[2][2][2] = { { { R, R }, { S, T } },
+                                                { { T, S }, { P, P } } };
+
+        // each strategy's pairings are one task; machines are only read, so
+        // the states of a game are kept here rather than in the machines
+        auto play = [&] (size_t red)
+        {
+            const simple_machine<2,2> & red_machine = a_population[red].genes;
+            double score = 0.0;
+
+            for (size_t blue = 0; blue < a_population.size(); ++blue)
+            {
+                // don't test against self
+                if (red != blue)
+                {
+                    const simple_machine<2,2> & blue_machine = a_population[blue].genes;
+
+                    // starting state for machines
+                    size_t red_state  = red_machine.init_state();
+                    size_t blue_state = blue_machine.init_state();
+
+                    // random "previous" move to get things going
+                    size_t prev_red_move  = 0; //rand_index(2);
+                    size_t prev_blue_move = 0; //rand_index(2);
+
+                    // play game for a given number of rounds
+                    for (size_t round = 0; round < m_rounds; ++round)
+                    {
+                        // transition to new state based on previous move
+                        const simple_machine<2,2>::tranout_t & red_tran  = red_machine.get_transition(red_state, prev_blue_move);
+                        const simple_machine<2,2>::tranout_t & blue_tran = blue_machine.get_transition(blue_state, prev_red_move);
+
+                        red_state  = red_tran.m_new_state;
+                        blue_state = blue_tran.m_new_state;
+
+                        // update fitness of test strategy
+                        score += payout[red_tran.m_output][blue_tran.m_output][0];
+
+                        // get ready for next round
+                        prev_red_move  = red_tran.m_output;
+                        prev_blue_move = blue_tran.m_output;
+                    }
+                }
+            }
+
+            a_population[red].fitness = score / static_cast<double>((a_population.size() - 1) * m_rounds);
+        };
+
+        if (m_pool != NULL)
+            m_pool->parallel_for(a_population.size(), play);
+        else
+        {
+            for (size_t red = 0; red < a_population.size(); ++red)
+                play(red);
+        }
+
+        double result = 0.0;
+
+        for (size_t red = 0; red < a_population.size(); ++red)
+            result += a_population[red].fitness;
+
+        // return average fitness
+        return result / (double)a_population.size();
+    }
+};
+
+#endif
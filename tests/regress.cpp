@@ -0,0 +1,862 @@
+/*
+    Evocosm is a C++ framework for implementing evolutionary algorithms.
+    It is part of the Drakontos Library of Interesting and Esoteric Oddities
+
+    Copyright 2016 Scott Robert Ladd. All rights reserved.
+
+    Evocosm is user-supported open source software. It's continued development is dependent on
+    financial support from the community. You can provide funding by visiting the Evocosm
+    website at:
+
+        http://www.drakontos.com
+
+    You license Evocosm under the Simplified BSD License (FreeBSD License).
+*/
+
+// Standard C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Evocosm
+#include "../evocosm/function_optimizer.h"
+#include "../evocosm/steady_state.h"
+#include "../evocosm/async_evocosm.h"
+#include "../evocosm/archipelago.h"
+#include "../evocosm/shm_migration.h"
+#include "../evocosm/work_stealing.h"
+using namespace libevocosm;
+
+// regression checks, run by "make check"
+//
+// Header templates are only compiled where they are used, so this program
+// also instantiates the ones the library itself never does. It prints each
+// failed check, and exits with status 1 if there were any.
+
+// number of failed checks
+static size_t g_failures = 0;
+
+static void check(bool a_passed, const char * a_what)
+{
+    if (!a_passed)
+    {
+        fprintf(stderr, "regress: FAILED: %s\n", a_what);
+        ++g_failures;
+    }
+}
+
+// access to the thread's generator
+class random_access : protected globals
+{
+public:
+    static prng & get()
+    {
+        return g_random;
+    }
+};
+
+// threads started together draw different sequences
+static void check_thread_seeds()
+{
+    static const size_t THREADS = 8;
+    unsigned long long int first[THREADS];
+    vector<std::thread> threads;
+
+    for (size_t n = 0; n < THREADS; ++n)
+        threads.push_back(std::thread([&first, n] () { first[n] = random_access::get().next(); }));
+
+    for (size_t n = 0; n < THREADS; ++n)
+        threads[n].join();
+
+    std::sort(first, first + THREADS);
+    check(std::unique(first, first + THREADS) == first + THREADS, "threads started together get different first draws");
+}
+
+// blocks freed on another thread go back to the thread that allocated them
+static void check_genome_pool_returns()
+{
+    static const size_t BLOCKS = 32;
+    bool returned = false;
+
+    std::thread owner([&returned] ()
+    {
+        vector<void *> first;
+
+        for (size_t n = 0; n < BLOCKS; ++n)
+            first.push_back(genome_pool::allocate(100));
+
+        std::thread([&first] ()
+        {
+            for (size_t n = 0; n < BLOCKS; ++n)
+                genome_pool::deallocate(first[n], 100);
+        }).join();
+
+        vector<void *> second;
+
+        for (size_t n = 0; n < BLOCKS; ++n)
+            second.push_back(genome_pool::allocate(100));
+
+        std::sort(first.begin(), first.end());
+        std::sort(second.begin(), second.end());
+        returned = (first == second);
+
+        for (size_t n = 0; n < BLOCKS; ++n)
+            genome_pool::deallocate(second[n], 100);
+    });
+
+    owner.join();
+    check(returned, "a thread gets back the blocks another thread frees");
+}
+
+// a bowl with its minimum at the origin
+static vector<double> sphere(vector<double> a_args)
+{
+    double sum = 0.0;
+
+    for (size_t n = 0; n < a_args.size(); ++n)
+        sum += a_args[n] * a_args[n];
+
+    vector<double> result(2);
+    result[0] = sum;
+    result[1] = 1.0 / (1.0 + sum);
+    return result;
+}
+
+// is an organism's fitness that of its genes? (mutation can make a gene NaN)
+static bool fitness_current(const function_solution & a_organism)
+{
+    double expected = sphere(vector<double>(a_organism.genes.begin(), a_organism.genes.end()))[1];
+    return (a_organism.fitness == expected) || ((a_organism.fitness != a_organism.fitness) && (expected != expected));
+}
+
+// a population of random solutions
+static vector<function_solution> make_population(size_t a_size, size_t a_dimensions)
+{
+    vector<function_solution> population;
+
+    for (size_t n = 0; n < a_size; ++n)
+        population.push_back(function_solution(static_cast<int>(a_dimensions), -5.0, 5.0));
+
+    return population;
+}
+
+// a mutator that remembers the children it was given
+class recording_mutator : public mutator<function_solution>
+{
+public:
+    recording_mutator(double a_rate)
+      : m_mutator(a_rate),
+        m_children()
+    {
+        // nada
+    }
+
+    virtual void mutate(vector<function_solution> & a_population)
+    {
+        m_mutator.mutate(a_population);
+
+        for (size_t n = 0; n < a_population.size(); ++n)
+            m_children.push_back(vector<double>(a_population[n].genes.begin(), a_population[n].genes.end()));
+    }
+
+    // are the first children different? later ones may repeat once the population converges
+    bool all_different(size_t a_count) const
+    {
+        size_t count = std::min(a_count, m_children.size());
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t j = i + 1; j < count; ++j)
+            {
+                if (m_children[i] == m_children[j])
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    size_t count() const
+    {
+        return m_children.size();
+    }
+
+private:
+    function_mutator m_mutator;
+    vector< vector<double> > m_children;
+};
+
+// successive steady-state births draw from different streams
+static void check_steady_state_births()
+{
+    random_access::get().set_seed(2);
+
+    function_listener   listener;
+    function_landscape  landscape(sphere, listener);
+    recording_mutator   mutator(0.1);
+    function_reproducer reproducer(1.0);
+    function_analyzer   analyzer(listener, 1000);
+
+    vector<function_solution> population = make_population(20, 4);
+
+    steady_state_evocosm<function_solution> cosm(population, landscape, mutator, reproducer, analyzer, listener);
+
+    for (size_t n = 0; n < 8; ++n)
+        cosm.run_step();
+
+    check(mutator.count() == 8, "steady_state_evocosm breeds one child per step");
+    check(mutator.all_different(4), "successive steady-state births produce different children");
+}
+
+// a landscape that counts tests run on the thread that created it
+class thread_landscape : public landscape<function_solution>
+{
+public:
+    thread_landscape(const landscape<function_solution> & a_landscape, listener<function_solution> & a_listener)
+      : landscape<function_solution>(a_listener),
+        m_landscape(a_landscape),
+        m_creator(std::this_thread::get_id()),
+        m_creator_tests(0)
+    {
+        // nada
+    }
+
+    virtual double test(function_solution & a_organism, bool a_verbose = false) const
+    {
+        if (std::this_thread::get_id() == m_creator)
+            ++m_creator_tests;
+
+        return m_landscape.test(a_organism, a_verbose);
+    }
+
+    const landscape<function_solution> & m_landscape;
+    std::thread::id m_creator;
+    mutable std::atomic<size_t> m_creator_tests;
+};
+
+// a work_stealing_pool runs every index once, survives exceptions, and runs nested loops inline
+static void check_work_stealing()
+{
+    work_stealing_pool pool(4);
+
+    static const size_t COUNTS[] = { 1, 3, 17, 1000, 4099 };
+    static const size_t GRAINS[] = { 1, 7, 64 };
+    bool once = true;
+
+    for (size_t c = 0; c < sizeof(COUNTS) / sizeof(COUNTS[0]); ++c)
+    {
+        for (size_t g = 0; g < sizeof(GRAINS) / sizeof(GRAINS[0]); ++g)
+        {
+            vector< std::atomic<int> > runs(COUNTS[c]);
+
+            for (size_t n = 0; n < runs.size(); ++n)
+                runs[n].store(0);
+
+            auto body = [&runs] (size_t n) { ++runs[n]; };
+            pool.parallel_for(runs.size(), body, GRAINS[g]);
+
+            for (size_t n = 0; n < runs.size(); ++n)
+                once = once && (runs[n].load() == 1);
+        }
+    }
+
+    check(once, "work_stealing_pool runs every index exactly once");
+
+    // iterations that take a while give every thread a chance to wake and help
+    vector<std::thread::id> runners(64);
+
+    auto slow = [&runners] (size_t n)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        runners[n] = std::this_thread::get_id();
+    };
+
+    pool.parallel_for(runners.size(), slow);
+    std::sort(runners.begin(), runners.end());
+    check(std::unique(runners.begin(), runners.end()) - runners.begin() > 1, "work_stealing_pool spreads a loop over several threads");
+
+    bool thrown = false;
+
+    try
+    {
+        auto failing = [] (size_t n)
+        {
+            if (n == 37)
+                throw std::runtime_error("work_stealing_pool");
+        };
+
+        pool.parallel_for(100, failing);
+    }
+    catch (std::runtime_error &)
+    {
+        thrown = true;
+    }
+
+    check(thrown, "work_stealing_pool rethrows an exception from a loop body");
+
+    std::atomic<size_t> after(0);
+    auto count = [&after] (size_t) { ++after; };
+    pool.parallel_for(500, count);
+    check(after.load() == 500, "work_stealing_pool runs loops after one throws");
+
+    std::atomic<size_t> inner_runs(0);
+    std::atomic<bool> inline_only(true);
+
+    auto outer = [&] (size_t)
+    {
+        std::thread::id self = std::this_thread::get_id();
+
+        auto inner = [&] (size_t)
+        {
+            ++inner_runs;
+
+            if (std::this_thread::get_id() != self)
+                inline_only.store(false);
+        };
+
+        pool.parallel_for(10, inner);
+    };
+
+    pool.parallel_for(8, outer);
+    check(inner_runs.load() == 80, "work_stealing_pool runs every index of nested loops");
+    check(inline_only.load(), "work_stealing_pool runs a nested loop on the calling thread");
+}
+
+// a stealing_landscape assigns the fitness a serial test does
+static void check_stealing_landscape()
+{
+    function_listener  listener;
+    function_landscape sphere_landscape(sphere, listener);
+    work_stealing_pool pool(3);
+    stealing_landscape<function_solution> landscape(listener, sphere_landscape, pool);
+
+    vector<function_solution> parallel = make_population(50, 4);
+    vector<function_solution> serial(parallel);
+
+    landscape.test(parallel);
+
+    for (size_t n = 0; n < serial.size(); ++n)
+        serial[n].fitness = sphere_landscape.test(serial[n]);
+
+    bool same = true;
+
+    for (size_t n = 0; n < serial.size(); ++n)
+        same = same && (parallel[n].fitness == serial[n].fitness) && (parallel[n].genes == serial[n].genes);
+
+    check(same, "stealing_landscape matches a serial test");
+}
+
+// a landscape whose tests throw on chosen calls
+class failing_landscape : public landscape<function_solution>
+{
+public:
+    failing_landscape(const landscape<function_solution> & a_landscape, listener<function_solution> & a_listener)
+      : landscape<function_solution>(a_listener),
+        m_landscape(a_landscape),
+        m_calls(0)
+    {
+        // nada
+    }
+
+    virtual double test(function_solution & a_organism, bool a_verbose = false) const
+    {
+        size_t call = m_calls++;
+
+        if ((call == 3) || (call == 50) || (call == 100))
+            throw std::runtime_error("failing_landscape");
+
+        return m_landscape.test(a_organism, a_verbose);
+    }
+
+    const landscape<function_solution> & m_landscape;
+    mutable std::atomic<size_t> m_calls;
+};
+
+// an async_evocosm builds, runs, and keeps its population whole
+static void check_async()
+{
+    random_access::get().set_seed(1);
+
+    function_listener   listener;
+    function_landscape  sphere_landscape(sphere, listener);
+    thread_landscape    landscape(sphere_landscape, listener);
+    recording_mutator   mutator(0.1);
+    function_reproducer reproducer(1.0);
+    function_analyzer   analyzer(listener, 1000);
+
+    vector<function_solution> population = make_population(20, 4);
+
+    async_evocosm<function_solution> cosm(population, landscape, mutator, reproducer, analyzer, listener, 2, 4);
+
+    for (size_t n = 0; n < 200; ++n)
+        cosm.run_step();
+
+    check(cosm.get_births() == 200, "async_evocosm counts every insertion as a birth");
+    check(cosm.get_population().size() == 20, "async_evocosm keeps the population size");
+
+    bool tested = true;
+
+    for (size_t n = 0; n < cosm.get_population().size(); ++n)
+        tested = tested && (cosm.get_population()[n].fitness > 0.0);
+
+    check(tested, "async_evocosm population has fitness values");
+    check(landscape.m_creator_tests.load() == 0, "async_evocosm workers test the initial population");
+    check(mutator.all_different(4), "async_evocosm candidates bred in a row are different");
+}
+
+// a test that throws on a worker is rethrown by the master, and the run goes on
+static void check_async_exceptions()
+{
+    function_listener   listener;
+    function_landscape  sphere_landscape(sphere, listener);
+    failing_landscape   landscape(sphere_landscape, listener);
+    function_mutator    mutator(0.1);
+    function_reproducer reproducer(1.0);
+    function_analyzer   analyzer(listener, 1000);
+
+    vector<function_solution> population = make_population(20, 4);
+
+    async_evocosm<function_solution> cosm(population, landscape, mutator, reproducer, analyzer, listener, 2, 4);
+
+    size_t errors = 0;
+
+    for (size_t n = 0; (n < 1000) && (cosm.get_births() < 100); ++n)
+    {
+        try
+        {
+            cosm.run_step();
+        }
+        catch (std::runtime_error &)
+        {
+            ++errors;
+        }
+    }
+
+    check(errors == 3, "async_evocosm rethrows each exception from a worker's test");
+    check(cosm.get_births() == 100, "async_evocosm goes on after a test throws");
+
+    bool tested = true;
+
+    for (size_t n = 0; n < cosm.get_population().size(); ++n)
+        tested = tested && (cosm.get_population()[n].fitness > 0.0);
+
+    check(tested, "async_evocosm inserts no organism whose test threw");
+}
+
+// after migration, every organism on an island has the fitness of its own genes
+class fitness_check : public test_hook<function_solution>
+{
+public:
+    fitness_check()
+      : m_calls(0),
+        m_stale(0)
+    {
+        // nada
+    }
+
+    virtual void tested(vector<function_solution> & a_population, size_t a_iteration)
+    {
+        ++m_calls;
+
+        for (size_t n = 0; n < a_population.size(); ++n)
+        {
+            if (!fitness_current(a_population[n]))
+                ++m_stale;
+        }
+    }
+
+    size_t m_calls;
+    size_t m_stale;
+};
+
+// one island of an archipelago, with its own components
+struct island
+{
+    island(size_t a_size)
+      : listener(),
+        landscape(sphere, listener),
+        mutator(0.1),
+        reproducer(1.0),
+        scaler(),
+        selector(0.5),
+        analyzer(listener, 1000),
+        population(make_population(a_size, 4)),
+        cosm(population, landscape, mutator, reproducer, scaler, selector, analyzer, listener)
+    {
+        // nada
+    }
+
+    function_listener                       listener;
+    function_landscape                      landscape;
+    function_mutator                        mutator;
+    function_reproducer                     reproducer;
+    linear_norm_scaler<function_solution>   scaler;
+    elitism_selector<function_solution>     selector;
+    function_analyzer                       analyzer;
+    vector<function_solution>               population;
+    evocosm<function_solution>              cosm;
+};
+
+// counts migrants posted with fitness other than that of their genes
+class checking_channel : public migration_channel<function_solution>
+{
+public:
+    checking_channel(migration_channel<function_solution> & a_channel)
+      : m_channel(a_channel),
+        m_stale(0)
+    {
+        // nada
+    }
+
+    virtual bool post(size_t a_island, const function_solution & a_migrant)
+    {
+        if (!fitness_current(a_migrant))
+            ++m_stale;
+
+        return m_channel.post(a_island, a_migrant);
+    }
+
+    virtual bool collect(size_t a_island, vector<function_solution> & a_arrivals)
+    {
+        return m_channel.collect(a_island, a_arrivals);
+    }
+
+    virtual migration_status & status()
+    {
+        return m_channel.status();
+    }
+
+    migration_channel<function_solution> & m_channel;
+    std::atomic<size_t> m_stale;
+};
+
+// an archipelago whose migrants pass through a checking_channel
+class checked_archipelago : public archipelago<function_solution>
+{
+public:
+    checked_archipelago(const vector<evocosm<function_solution> *> & a_islands)
+      : archipelago<function_solution>(a_islands, TOPOLOGY_RING, 1, 2, MIGRATE_BEST, 3),
+        m_checker(*m_channel)
+    {
+        m_channel = &m_checker;
+    }
+
+    size_t get_stale() const
+    {
+        return m_checker.m_stale.load();
+    }
+
+private:
+    checking_channel m_checker;
+};
+
+// migrants are chosen, and replace others, by fitness computed for them,
+// not by scaled fitness or fitness children were bred with
+static void check_archipelago()
+{
+    island first(20);
+    island second(20);
+
+    fitness_check checker;
+    second.cosm.set_test_hook(&checker);
+
+    vector<evocosm<function_solution> *> islands;
+    islands.push_back(&first.cosm);
+    islands.push_back(&second.cosm);
+
+    checked_archipelago ring(islands);
+
+    check(ring.run(20), "archipelago runs every generation");
+    check(ring.get_migrants_sent() > 0, "archipelago islands send migrants");
+    check(ring.get_stale() == 0, "archipelago emigrants carry the fitness of their genes");
+    check(checker.m_calls == 20, "archipelago keeps an island's own test hook");
+    check(checker.m_stale == 0, "archipelago migration leaves every organism with its own fitness");
+    check(second.cosm.get_test_hook() == &checker, "archipelago restores an island's test hook");
+}
+
+// wait up to a few seconds for a message
+static bool await_message(shm_rings & a_rings, size_t a_ring, vector<unsigned char> & a_data)
+{
+    for (size_t n = 0; n < 5000; ++n)
+    {
+        if (a_rings.pop(a_ring, a_data))
+            return true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+}
+
+// shared memory rings carry messages both ways between processes, and reset empties them
+static void check_shm_rings()
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/evocosm-regress-%d", static_cast<int>(getpid()));
+
+    shm_rings rings(name, 2, 4, 64);
+
+    static const char FROM_PARENT[] = "parent";
+    static const char FROM_CHILD[]  = "child";
+
+    fflush(NULL);
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        vector<unsigned char> data;
+        bool ok = rings.push(1, FROM_CHILD, sizeof(FROM_CHILD))
+               && await_message(rings, 0, data)
+               && (data == vector<unsigned char>(FROM_PARENT, FROM_PARENT + sizeof(FROM_PARENT)));
+        _exit(ok ? 0 : 1);
+    }
+
+    vector<unsigned char> data;
+    bool sent = rings.push(0, FROM_PARENT, sizeof(FROM_PARENT));
+    bool received = await_message(rings, 1, data) && (data == vector<unsigned char>(FROM_CHILD, FROM_CHILD + sizeof(FROM_CHILD)));
+
+    int status = 1;
+    waitpid(pid, &status, 0);
+
+    check(sent && received && WIFEXITED(status) && (WEXITSTATUS(status) == 0), "shm_rings exchange messages between processes");
+
+    while (rings.push(0, FROM_PARENT, sizeof(FROM_PARENT)))
+    {
+        // fill it
+    }
+
+    rings.reset();
+    check(!rings.pop(0, data) && rings.push(0, FROM_PARENT, sizeof(FROM_PARENT)), "shm_rings reset empties a full ring");
+}
+
+// islands forked into processes exchange migrants and come back evolved
+static void check_process_archipelago()
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/evocosm-regress-islands-%d", static_cast<int>(getpid()));
+
+    island first(20);
+    island second(20);
+
+    vector<evocosm<function_solution> *> islands;
+    islands.push_back(&first.cosm);
+    islands.push_back(&second.cosm);
+
+    vector<function_solution> before = second.cosm.get_population();
+
+    shm_channel<function_solution> channel(name, islands.size());
+    process_archipelago<function_solution> processes(islands, channel, archipelago<function_solution>::TOPOLOGY_RING, 2);
+
+    check(processes.run(10), "process_archipelago runs every generation");
+    check(processes.get_failures() == 0, "process_archipelago islands all finish");
+    check(processes.get_migrants_sent() > 0, "process_archipelago islands send migrants through shared memory");
+
+    bool evolved = false;
+
+    for (size_t n = 0; n < before.size(); ++n)
+        evolved = evolved || (before[n].genes != second.cosm.get_population()[n].genes);
+
+    check(evolved, "process_archipelago brings back an island's evolved population");
+}
+
+#if defined(EVOCOSM_METRICS)
+// stops evolution at the first yield
+class stopping_scheduler : public scheduler
+{
+public:
+    virtual bool yield()
+    {
+        return false;
+    }
+};
+
+// counts metrics reports
+class metrics_listener : public function_listener
+{
+public:
+    metrics_listener()
+      : m_reports(0)
+    {
+        // nada
+    }
+
+    virtual void ping_generation_metrics(const generation_metrics & a_metrics)
+    {
+        ++m_reports;
+    }
+
+    size_t m_reports;
+};
+
+// an evocosm whose recorder can be inspected
+class recorded_evocosm : public evocosm<function_solution>
+{
+public:
+    recorded_evocosm(island & a_island, listener<function_solution> & a_listener)
+      : evocosm<function_solution>(a_island.population, a_island.landscape, a_island.mutator, a_island.reproducer,
+                                   a_island.scaler, a_island.selector, a_island.analyzer, a_listener)
+    {
+        // nada
+    }
+
+    generation_metrics & get_metrics()
+    {
+        return m_metrics.metrics();
+    }
+};
+
+// a generation stopped by the scheduler leaves no recorder active, and isn't reported
+static void check_stopped_metrics()
+{
+    island parts(10);
+    metrics_listener listener;
+    recorded_evocosm cosm(parts, listener);
+    stopping_scheduler stopper;
+
+    cosm.run_generation();
+    check(listener.m_reports == 1, "a finished generation reports metrics");
+
+    cosm.set_scheduler(stopper);
+    check(!cosm.run_generation(), "a stopping scheduler stops the generation");
+
+    metrics_recorder::count_children(5);
+    check(cosm.get_metrics().children == 0, "a stopped generation leaves no recorder active");
+    check(listener.m_reports == 1, "a stopped generation reports no metrics");
+}
+#endif
+
+// buffering leaves a generator's sequence as its engine's, across restores and reseeding
+template <class Engine>
+static void check_buffered_prng(const char * a_what)
+{
+    static const size_t COUNT = 1000;
+
+    basic_prng<Engine> random(7);
+    Engine engine;
+    engine.seed(7);
+
+    bool same = true;
+
+    for (size_t n = 0; n < COUNT; ++n)
+        same = same && (random.next() == engine.next());
+
+    // stop partway through a block, and carry on in another generator
+    for (size_t n = 0; n < 37; ++n)
+        random.get_real();
+
+    unsigned long long int state[basic_prng<Engine>::STATE_WORDS];
+    random.get_state(state);
+
+    basic_prng<Engine> restored(99);
+    restored.set_state(state);
+
+    bool continued = true;
+
+    for (size_t n = 0; n < COUNT; ++n)
+        continued = continued && (random.get_real() == restored.get_real());
+
+    // a keyed stream starts fresh, whatever was left in the buffer
+    random.set_stream(3, 5, STREAM_MUTATE);
+    double first = random.get_real();
+    random.next();
+    random.set_stream(3, 5, STREAM_MUTATE);
+
+    check(same, a_what);
+    check(continued, a_what);
+    check(random.get_real() == first, a_what);
+}
+
+// a checkpoint file reads back, and is refused when its header doesn't match
+static void check_checkpoint_header()
+{
+    const char * name = "regress.ckpt";
+
+    checkpoint_writer image;
+    image.put(static_cast<uint64_t>(12345));
+
+    checkpointer saver(name);
+    saver.save(image);
+    check(saver.wait(), "checkpointer writes a file");
+
+    vector<unsigned char> loaded;
+    checkpointer::load(name, loaded);
+    checkpoint_reader reader(loaded);
+    check(reader.get<uint64_t>() == 12345, "checkpointer reads back what it wrote");
+
+    // header: magic, version, flags, engine, random state words, length
+    const long offsets[] = { 8, 16, 20 };
+
+    for (size_t n = 0; n < sizeof(offsets) / sizeof(offsets[0]); ++n)
+    {
+        FILE * file = fopen(name, "r+b");
+
+        if (file == NULL)
+        {
+            check(false, "checkpoint file can be reopened");
+            return;
+        }
+
+        uint32_t field;
+        fseek(file, offsets[n], SEEK_SET);
+        check(fread(&field, sizeof(field), 1, file) == 1, "checkpoint header can be read");
+
+        uint32_t wrong = field + 1;
+        fseek(file, offsets[n], SEEK_SET);
+        fwrite(&wrong, sizeof(wrong), 1, file);
+        fclose(file);
+
+        bool refused = false;
+
+        try
+        {
+            checkpointer::load(name, loaded);
+        }
+        catch (std::runtime_error &)
+        {
+            refused = true;
+        }
+
+        check(refused, "checkpointer refuses another version, engine or random state size");
+
+        file = fopen(name, "r+b");
+
+        if (file != NULL)
+        {
+            fseek(file, offsets[n], SEEK_SET);
+            fwrite(&field, sizeof(field), 1, file);
+            fclose(file);
+        }
+    }
+
+    remove(name);
+}
+
+int main()
+{
+    check_thread_seeds();
+    check_genome_pool_returns();
+    check_buffered_prng<xoshiro256_engine>("an unbuffered generator gives its engine's sequence, and restores exactly");
+    check_buffered_prng<philox_engine>("a buffered generator gives its engine's sequence, and restores exactly");
+    check_steady_state_births();
+    check_work_stealing();
+    check_stealing_landscape();
+    check_async();
+    check_async_exceptions();
+    check_archipelago();
+    check_shm_rings();
+    check_process_archipelago();
+#if defined(EVOCOSM_METRICS)
+    check_stopped_metrics();
+#endif
+    check_checkpoint_header();
+
+    if (g_failures == 0)
+        printf("regress: all checks passed\n");
+
+    return (g_failures == 0) ? 0 : 1;
+}